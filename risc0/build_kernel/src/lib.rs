@@ -40,6 +40,7 @@ pub struct KernelBuild {
     files: Vec<PathBuf>,
     inc_dirs: Vec<PathBuf>,
     deps: Vec<PathBuf>,
+    link: bool,
 }
 
 impl KernelBuild {
@@ -50,6 +51,7 @@ impl KernelBuild {
             files: Vec::new(),
             inc_dirs: Vec::new(),
             deps: Vec::new(),
+            link: true,
         }
     }
 
@@ -115,6 +117,13 @@ impl KernelBuild {
         self
     }
 
+    /// Build the library without linking it into the crate. It is left in `OUT_DIR` for targets
+    /// that link it themselves, e.g. with `#[link]` on a `#[cfg(test)]` extern block.
+    pub fn no_link(&mut self) -> &mut KernelBuild {
+        self.link = false;
+        self
+    }
+
     pub fn compile(&mut self, output: &str) {
         println!("cargo:rerun-if-env-changed=RISC0_SKIP_BUILD_KERNELS");
         for src in self.files.iter() {
@@ -137,7 +146,8 @@ impl KernelBuild {
 
         // It's *highly* recommended to install `sccache` and use this combined with
         // `RUSTC_WRAPPER=/path/to/sccache` to speed up rebuilds of C++ kernels
-        cc::Build::new()
+        let mut build = cc::Build::new();
+        build
             .cpp(true)
             .debug(false)
             .files(&self.files)
@@ -146,8 +156,28 @@ impl KernelBuild {
             .flag_if_supported("-std=c++17")
             .flag_if_supported("-fno-var-tracking")
             .flag_if_supported("-fno-var-tracking-assignments")
-            .flag_if_supported("-g0")
-            .compile(output);
+            .flag_if_supported("-g0");
+        // Build with the same vector extensions as the Rust code, so that the AVX2 and AVX-512
+        // paths of FpVec follow RUSTFLAGS="-C target-cpu=native".
+        if env::var("CARGO_CFG_TARGET_ENV").as_deref() != Ok("msvc") {
+            let features = env::var("CARGO_CFG_TARGET_FEATURE").unwrap_or_default();
+            for (feature, flag) in [("avx2", "-mavx2"), ("avx512f", "-mavx512f")] {
+                if features.split(',').any(|x| x == feature) {
+                    build.flag(flag);
+                }
+            }
+        }
+        for flag in self.flags.iter() {
+            build.flag(flag);
+        }
+        if !self.link {
+            build.cargo_metadata(false);
+            println!(
+                "cargo:rustc-link-search=native={}",
+                env::var("OUT_DIR").unwrap()
+            );
+        }
+        build.compile(output);
     }
 
     fn compile_cuda(&mut self, output: &str) {
@@ -29,10 +29,17 @@ fn main() {
 
 fn build_cpu_kernels() {
     rerun_if_changed("kernels/cxx");
-    KernelBuild::new(KernelType::Cpp)
+    println!("cargo:rerun-if-env-changed=RISC0_WITGEN_UNCHECKED");
+
+    let mut build = KernelBuild::new(KernelType::Cpp);
+    build
         .files(glob_paths("kernels/cxx/*.cpp"))
-        .include(env::var("DEP_RISC0_SYS_CXX_ROOT").unwrap())
-        .compile("risc0_keccak_cpu");
+        .include(env::var("DEP_RISC0_SYS_CXX_ROOT").unwrap());
+    // Drop the per-element consistency checks in witness generation, with RISC0_WITGEN_UNCHECKED=1.
+    if env::var("RISC0_WITGEN_UNCHECKED").is_ok_and(|x| x == "1" || x == "true") {
+        build.flag("-DRISC0_WITGEN_UNCHECKED");
+    }
+    build.compile("risc0_keccak_cpu");
 }
 
 fn build_cuda_kernels() {
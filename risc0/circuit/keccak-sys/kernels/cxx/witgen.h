@@ -132,41 +132,86 @@ struct Reg {
   size_t col;
 };
 
-struct BufferObj {
-  virtual Val load(ExecContext& ctx, size_t col, size_t back) = 0;
-  virtual void store(ExecContext& ctx, size_t col, Val val) = 0;
-};
-
-struct MutableBufObj : public BufferObj {
-  MutableBufObj(Buffer& buf) : buf(buf) {}
+// Buffer checking policy.  Checked builds throw on a write that conflicts with an existing value,
+// and on a read of an unset (Fp::invalid()) element when the buffer's 'checkedReads' flag is set.
+// Production builds can define RISC0_WITGEN_UNCHECKED to compile these comparisons out.
+#if defined(RISC0_WITGEN_UNCHECKED)
+constexpr bool kCheckedBuffers = false;
+#else
+constexpr bool kCheckedBuffers = true;
+#endif
 
-  Val load(ExecContext& ctx, size_t col, size_t back) override {
+// A non-virtual view of a column-major Buffer, so that every LOAD and STORE in the generated step
+// code inlines.  Global buffers are treated as a single row (rowMask == 0), which lets both kinds
+// share the same code.
+template <bool Checked> struct BufferObjT {
+  Val load(ExecContext& ctx, size_t col, size_t back) {
+    assert(!isGlobal || back == 0);
     if (back > ctx.cycle) {
       return 0;
     }
-    return buf.get(ctx.cycle - back, col);
+    size_t row = (ctx.cycle - back) & rowMask;
+    Val ret = buf[col * rows + row];
+    if constexpr (Checked) {
+      if (ret == Fp::invalid() && checkedReads) {
+        invalidRead(row, col);
+      }
+    }
+    return ret;
   }
 
-  void store(ExecContext& ctx, size_t col, Val val) override {
-    return buf.set(ctx.cycle, col, val);
+  void store(ExecContext& ctx, size_t col, Val val) {
+    size_t row = ctx.cycle & rowMask;
+    Val& elem = buf[col * rows + row];
+    if constexpr (Checked) {
+      if (elem != Fp::invalid() && elem != val) {
+        inconsistentSet(row, col, val, elem);
+      }
+    }
+    elem = val;
   }
 
-  Buffer& buf;
-};
+protected:
+  BufferObjT(Buffer& buf, size_t rowMask, bool isGlobal)
+      : buf(buf.buf)
+      , rows(buf.rows)
+      , rowMask(rowMask)
+      , checkedReads(buf.checkedReads)
+      , isGlobal(isGlobal) {}
+
+private:
+  Fp* buf;
+  size_t rows;
+  size_t rowMask;
+  bool checkedReads;
+  bool isGlobal;
+
+  [[noreturn]] __attribute__((noinline)) void invalidRead(size_t row, size_t col) {
+    printf("get(row: %zu, col: %zu) -> 0x%08x\n", row, col, Fp::invalid().asRaw());
+    throw std::runtime_error("Read of unset value");
+  }
 
-using MutableBuf = MutableBufObj*;
+  [[noreturn]] __attribute__((noinline)) void
+  inconsistentSet(size_t row, size_t col, Val val, Val cur) {
+    printf("set(row: %zu, col: %zu, val: 0x%08x) cur: 0x%08x\n",
+           row,
+           col,
+           val.asUInt32(),
+           cur.asUInt32());
+    throw std::runtime_error("Inconsistent set");
+  }
+};
 
-struct GlobalBufObj : public BufferObj {
-  GlobalBufObj(Buffer& buf) : buf(buf) {}
+using BufferObj = BufferObjT<kCheckedBuffers>;
 
-  Val load(ExecContext& ctx, size_t col, size_t back) override {
-    assert(back == 0);
-    return buf.get(0, col);
-  }
+struct MutableBufObj : public BufferObj {
+  MutableBufObj(Buffer& buf) : BufferObj(buf, ~size_t(0), false) {}
+};
 
-  void store(ExecContext& ctx, size_t col, Val val) override { return buf.set(0, col, val); }
+using MutableBuf = MutableBufObj*;
 
-  Buffer& buf;
+struct GlobalBufObj : public BufferObj {
+  GlobalBufObj(Buffer& buf) : BufferObj(buf, 0, true) {}
 };
 
 using GlobalBuf = GlobalBufObj*;
@@ -16,6 +16,7 @@
 
 #include "fpext.h"
 
+#include <stdexcept>
 #include <tuple>
 #include <vector>
 
@@ -67,8 +68,22 @@ struct RamArgumentRow {
   }
 };
 
+struct MachineContext;
+
+// The read cursors of the cycle that a thread is executing.  ramRead, syscallBody and syscallFini
+// each consume the next transaction or extra word of their cycle, so the cursors advance as the
+// cycle runs.  They start from the preflight trace at the beginning of each cycle and live with the
+// thread rather than in the trace, so the trace is never written and a cycle can be re-run on any
+// thread.
+struct CycleCursor {
+  const MachineContext* ctx = nullptr;
+  size_t cycle = 0;
+  uint32_t memIdx = 0;
+  uint32_t extraIdx = 0;
+};
+
 struct MachineContext {
-  PreflightTrace* trace;
+  const PreflightTrace* trace;
   uint32_t steps;
 
   std::vector<RamArgumentRow> ramRows;
@@ -77,13 +92,34 @@ struct MachineContext {
   std::vector<uint32_t> pairs;
   std::vector<uint32_t> pairsIndex;
 
-  MachineContext(PreflightTrace* trace, uint32_t steps);
+  MachineContext(const PreflightTrace* trace, uint32_t steps);
 
   void sortRam();
   void sortBytes();
 
+  // Start executing cycle on the calling thread, which must be done before each step_exec.
+  void beginCycle(size_t cycle) const {
+    const PreflightCycle& preflight = trace->cycles[cycle];
+    threadCursor() = CycleCursor{this, cycle, preflight.memIdx, preflight.extraIdx};
+  }
+
+  // The calling thread's cursors, which must belong to cycle.
+  CycleCursor& cursor(size_t cycle) const {
+    CycleCursor& cur = threadCursor();
+    if (cur.ctx != this || cur.cycle != cycle) {
+      throw std::runtime_error("Cycle executed without beginCycle");
+    }
+    return cur;
+  }
+
   bool isParSafeExec(uint32_t cycle) const { return trace->cycles[cycle].isSafeExec; }
   uint8_t isParSafeVerifyMem(uint32_t cycle) const { return trace->cycles[cycle].isSafeVerifyMem; }
+
+private:
+  static CycleCursor& threadCursor() {
+    thread_local CycleCursor cur;
+    return cur;
+  }
 };
 
 struct AccumCell {
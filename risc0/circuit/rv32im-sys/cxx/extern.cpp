@@ -49,7 +49,7 @@ void extern_trace(void* ctx, size_t cycle, const char* extra, std::array<Fp, 1>
 }
 
 Fp extern_getMajor(void* ctx, size_t cycle, const char* extra, std::array<Fp, 2> args) {
-  PreflightTrace* trace = static_cast<MachineContext*>(ctx)->trace;
+  const PreflightTrace* trace = static_cast<MachineContext*>(ctx)->trace;
   uint32_t major = trace->cycles[cycle].major;
   // printf("[%lu] getMajor: %u\n", cycle, major);
   return major;
@@ -57,17 +57,18 @@ Fp extern_getMajor(void* ctx, size_t cycle, const char* extra, std::array<Fp, 2>
 
 Fp extern_getMinor(void* ctx, size_t cycle, const char* extra, std::array<Fp, 4> args) {
   // printf("getMinor\n");
-  PreflightTrace* trace = static_cast<MachineContext*>(ctx)->trace;
+  const PreflightTrace* trace = static_cast<MachineContext*>(ctx)->trace;
   return trace->cycles[cycle].minor;
 }
 
 std::array<Fp, 3>
 extern_pageInfo(void* ctx, size_t cycle, const char* extra, std::array<Fp, 1> args) {
-  PreflightTrace* trace = static_cast<MachineContext*>(ctx)->trace;
+  const MachineContext* mctx = static_cast<MachineContext*>(ctx);
+  const PreflightTrace* trace = mctx->trace;
   if (trace->isTrace) {
     printf("pageInfo\n");
   }
-  size_t idx = trace->cycles[cycle].extraIdx;
+  size_t idx = mctx->cursor(cycle).extraIdx;
   uint32_t isRead = trace->extras[idx + 0];
   uint32_t pageIdx = trace->extras[idx + 1];
   uint32_t isDone = trace->extras[idx + 2];
@@ -80,10 +81,11 @@ void extern_ramWrite(void* ctx, size_t cycle, const char* extra, std::array<Fp,
 
 std::array<Fp, 4>
 extern_ramRead(void* ctx, size_t cycle, const char* extra, std::array<Fp, 2> args) {
-  PreflightTrace* trace = static_cast<MachineContext*>(ctx)->trace;
+  const MachineContext* mctx = static_cast<MachineContext*>(ctx);
+  const PreflightTrace* trace = mctx->trace;
   uint32_t addr = args[0].asUInt32();
-  size_t memIdx = trace->cycles[cycle].memIdx++;
-  MemoryTransaction& txn = trace->txns[memIdx];
+  size_t memIdx = mctx->cursor(cycle).memIdx++;
+  const MemoryTransaction& txn = trace->txns[memIdx];
   if (trace->isTrace) {
     printf("ramRead(%lu, 0x%08x): txn(%u, 0x%08x): 0x%08x\n",
            cycle,
@@ -108,8 +110,9 @@ extern_ramRead(void* ctx, size_t cycle, const char* extra, std::array<Fp, 2> arg
 
 std::array<Fp, 4>
 extern_syscallBody(void* ctx, size_t cycle, const char* extra, std::array<Fp, 0> args) {
-  PreflightTrace* trace = static_cast<MachineContext*>(ctx)->trace;
-  size_t extraIdx = trace->cycles[cycle].extraIdx++;
+  const MachineContext* mctx = static_cast<MachineContext*>(ctx);
+  const PreflightTrace* trace = mctx->trace;
+  size_t extraIdx = mctx->cursor(cycle).extraIdx++;
   uint32_t word = trace->extras[extraIdx];
   return {
       Fp(word & 0xff),
@@ -121,8 +124,9 @@ extern_syscallBody(void* ctx, size_t cycle, const char* extra, std::array<Fp, 0>
 
 std::array<Fp, 8>
 extern_syscallFini(void* ctx, size_t cycle, const char* extra, std::array<Fp, 0> args) {
-  PreflightTrace* trace = static_cast<MachineContext*>(ctx)->trace;
-  size_t extraIdx = trace->cycles[cycle].extraIdx++;
+  const MachineContext* mctx = static_cast<MachineContext*>(ctx);
+  const PreflightTrace* trace = mctx->trace;
+  size_t extraIdx = mctx->cursor(cycle).extraIdx++;
   uint32_t a0 = trace->extras[extraIdx + 0];
   uint32_t a1 = trace->extras[extraIdx + 1];
   return {
@@ -187,7 +191,7 @@ extern_divide(void* ctx, size_t cycle, const char* extra, std::array<Fp, 9> args
 }
 
 void extern_log(void* ctx, size_t cycle, const char* extra, std::vector<Fp> args) {
-  PreflightTrace* trace = static_cast<MachineContext*>(ctx)->trace;
+  const PreflightTrace* trace = static_cast<MachineContext*>(ctx)->trace;
   if (!trace->isTrace) {
     return;
   }
@@ -356,8 +360,9 @@ void extern_syscallBigInt2Precompute(void* ctx,
 
 std::array<Fp, 16>
 extern_syscallBigInt2Witness(void* ctx, size_t cycle, const char* extra, std::array<Fp, 5> args) {
-  PreflightTrace* trace = static_cast<MachineContext*>(ctx)->trace;
-  size_t extraIdx = trace->cycles[cycle].extraIdx;
+  const MachineContext* mctx = static_cast<MachineContext*>(ctx);
+  const PreflightTrace* trace = mctx->trace;
+  size_t extraIdx = mctx->cursor(cycle).extraIdx;
   uint32_t a0 = trace->extras[extraIdx + 0];
   uint32_t a1 = trace->extras[extraIdx + 1];
   uint32_t a2 = trace->extras[extraIdx + 2];
@@ -57,6 +57,11 @@ using Reg = size_t;
 
 } // namespace
 
+void exec_cycle(MachineContext* ctx, uint32_t steps, uint32_t cycle, Fp** args) {
+  ctx->beginCycle(cycle);
+  step_exec(ctx, steps, cycle, args);
+}
+
 void par_step_exec(MachineContext* ctx,
                    uint32_t steps,
                    uint32_t cycle,
@@ -67,10 +72,10 @@ void par_step_exec(MachineContext* ctx,
   std::array<Fp*, 3> args{ctrl, io, data};
   if (cycle == 0 || ctx->isParSafeExec(cycle)) {
     // printf("step_exec(%u)\n", cycle);
-    step_exec(ctx, steps, cycle++, args.data());
+    exec_cycle(ctx, steps, cycle++, args.data());
     while (cycle < count && !ctx->isParSafeExec(cycle)) {
       // printf("step_exec(%u)\n", cycle);
-      step_exec(ctx, steps, cycle++, args.data());
+      exec_cycle(ctx, steps, cycle++, args.data());
     }
   }
 }
@@ -204,7 +209,7 @@ void inject_backs_bytes(MachineContext* ctx, size_t steps, size_t cycle, Fp* dat
 
 namespace risc0::circuit::rv32im {
 
-MachineContext::MachineContext(PreflightTrace* trace, uint32_t steps)
+MachineContext::MachineContext(const PreflightTrace* trace, uint32_t steps)
     : trace(trace)
     , steps(steps)
     , ramRows(steps * kMaxRamRowsPerCycle,
@@ -243,7 +248,7 @@ void do_step_exec(
   } break;
   case kStepModeSeqForward: {
     for (size_t i = 0; i < last_cycle; i++) {
-      step_exec(ctx, ctx->steps, i, args.data());
+      exec_cycle(ctx, ctx->steps, i, args.data());
     }
   } break;
   case kStepModeSeqReverse: {
@@ -258,7 +263,7 @@ void do_step_exec(
 extern "C" {
 
 const char* risc0_circuit_rv32im_cpu_witgen(uint32_t mode,
-                                            PreflightTrace* trace,
+                                            const PreflightTrace* trace,
                                             uint32_t steps,
                                             uint32_t last_cycle,
                                             Fp* ctrl,
@@ -13,7 +13,7 @@
 // limitations under the License.
 
 use std::{
-    env,
+    env, fs,
     path::{Path, PathBuf},
 };
 
@@ -29,13 +29,83 @@ fn main() {
 
 fn build_cpu_kernels() {
     rerun_if_changed("kernels/cxx");
-    KernelBuild::new(KernelType::Cpp)
+    check_tap_backs();
+    check_lanes_namespace();
+    println!("cargo:rerun-if-env-changed=RISC0_WITGEN_UNCHECKED");
+
+    let mut build = KernelBuild::new(KernelType::Cpp);
+    build
         .files(glob_paths("kernels/cxx/*.cpp"))
         .deps(glob_paths("kernels/cxx/*.h"))
         .deps(glob_paths("kernels/cxx/*.cpp.inc"))
         .deps(glob_paths("kernels/cxx/*.h.inc"))
-        .include(env::var("DEP_RISC0_SYS_CXX_ROOT").unwrap())
-        .compile("risc0_rv32im_v2_cpu");
+        .include(env::var("DEP_RISC0_SYS_CXX_ROOT").unwrap());
+    // Drop the per-element consistency checks in witness generation, with RISC0_WITGEN_UNCHECKED=1.
+    if env::var("RISC0_WITGEN_UNCHECKED").is_ok_and(|x| x == "1" || x == "true") {
+        build.flag("-DRISC0_WITGEN_UNCHECKED");
+    }
+    build.compile("risc0_rv32im_v2_cpu");
+}
+
+/// The SIMD lanes of eval_check only repack the rows of the accum and data buffers at the tap backs
+/// listed in kTapBacks in poly_fp_lanes.h, and any other row reads as garbage. So check that every
+/// tap `(cycle - kInvRate * B)` of the generated rust_poly_fp_*.cpp has its B in the list, which
+/// catches a regenerated circuit with new taps at build time.
+fn check_tap_backs() {
+    let header = fs::read_to_string("kernels/cxx/poly_fp_lanes.h").unwrap();
+    let list = header
+        .split("kTapBacks[] = {")
+        .nth(1)
+        .and_then(|x| x.split('}').next())
+        .expect("kTapBacks not found in poly_fp_lanes.h");
+    let backs: Vec<u32> = list.split(',').map(|x| x.trim().parse().unwrap()).collect();
+    for path in glob_paths("kernels/cxx/rust_poly_fp_*.cpp") {
+        let src = fs::read_to_string(&path).unwrap();
+        for tap in src.split("cycle - kInvRate * ").skip(1) {
+            let digits = tap.split(|c: char| !c.is_ascii_digit()).next().unwrap();
+            let back: u32 = digits
+                .parse()
+                .unwrap_or_else(|_| panic!("{}: tap back is not a literal", path.display()));
+            assert!(
+                backs.contains(&back),
+                "{}: tap back {back} is missing from kTapBacks in poly_fp_lanes.h",
+                path.display()
+            );
+        }
+    }
+}
+
+/// poly_fp_lanes_*.cpp recompile the generated rust_poly_fp_*.cpp in rv32im_v2::lanes by defining
+/// rv32im_v2 as a macro around the include. That only works if the generated code names its
+/// namespace in the opening line and its closing comment, and nowhere else, so check that too.
+fn check_lanes_namespace() {
+    const NAME: &str = "rv32im_v2";
+    const OPEN: &str = "namespace risc0::circuit::rv32im_v2 {";
+    const CLOSE: &str = "} // namespace risc0::circuit::rv32im_v2";
+    let is_ident = |c: char| c.is_ascii_alphanumeric() || c == '_';
+    for path in glob_paths("kernels/cxx/rust_poly_fp_*.cpp") {
+        let src = fs::read_to_string(&path).unwrap();
+        let (mut open, mut close) = (0, 0);
+        for line in src.lines() {
+            let uses = line.match_indices(NAME).any(|(i, _)| {
+                !line[..i].ends_with(is_ident) && !line[i + NAME.len()..].starts_with(is_ident)
+            });
+            match line.trim() {
+                OPEN => open += 1,
+                CLOSE => close += 1,
+                _ => assert!(
+                    !uses,
+                    "{}: names {NAME} outside of its namespace lines: {line}",
+                    path.display()
+                ),
+            }
+        }
+        assert!(
+            open == 1 && close == 1,
+            "{}: expected a single `{OPEN}` and `{CLOSE}`",
+            path.display()
+        );
+    }
 }
 
 fn build_cuda_kernels() {
@@ -60,7 +60,7 @@ struct HostExecContext {
   PreflightTrace d_preflight;
   LookupTables d_tables;
 
-  HostExecContext(ExecBuffers* buffers, PreflightTrace* preflight, size_t cycles) {
+  HostExecContext(ExecBuffers* buffers, const PreflightTrace* preflight, size_t cycles) {
     CUDA_OK(cudaMallocManaged(&ctx, sizeof(DeviceExecContext)));
 
     CUDA_OK(cudaMalloc(&ctx->data, sizeof(Buffer)));
@@ -140,7 +140,7 @@ struct HostAccumContext {
   PreflightTrace d_preflight;
   LookupTables d_tables;
 
-  HostAccumContext(AccumBuffers* buffers, PreflightTrace* preflight, size_t cycles) {
+  HostAccumContext(AccumBuffers* buffers, const PreflightTrace* preflight, size_t cycles) {
     CUDA_OK(cudaMallocManaged(&ctx, sizeof(DeviceAccumContext)));
 
     CUDA_OK(cudaMalloc(&ctx->data, sizeof(Buffer)));
@@ -232,7 +232,7 @@ divide_rv32im(uint32_t numer, uint32_t denom, uint32_t signType) {
 
 __device__ ::cuda::std::array<Val, 5> extern_getMemoryTxn(ExecContext& ctx, Val addrElem) {
   uint32_t addr = addrElem.asUInt32();
-  size_t txnIdx = ctx.preflight.cycles[ctx.cycle].txnIdx++;
+  size_t txnIdx = ctx.txnIdx++;
   const MemoryTransaction& txn = ctx.preflight.txns[txnIdx];
   // printf("getMemoryTxn(%lu, 0x%08x): txn(%u, 0x%08x, 0x%08x)\n",
   //        ctx.cycle,
@@ -322,7 +322,7 @@ __device__ ::cuda::std::array<Val, 2> extern_getMajorMinor(ExecContext& ctx) {
 }
 
 __device__ Val extern_hostReadPrepare(ExecContext& ctx, Val fp, Val len) {
-  size_t txnIdx = ctx.preflight.cycles[ctx.cycle].txnIdx;
+  size_t txnIdx = ctx.txnIdx;
   uint32_t word = ctx.preflight.txns[txnIdx].word;
   // printf("[%lu]: hostReadPrepare(txnIdx: %zu, word: 0x%08x)\n", ctx.cycle, txnIdx, word);
   return word;
@@ -331,7 +331,7 @@ __device__ Val extern_hostReadPrepare(ExecContext& ctx, Val fp, Val len) {
 __device__ Val
 extern_hostWrite(ExecContext& ctx, Val fdVal, Val addrLow, Val addrHigh, Val lenVal) {
   // printf("hostWrite\n");
-  size_t txnIdx = ctx.preflight.cycles[ctx.cycle].txnIdx;
+  size_t txnIdx = ctx.txnIdx;
   return ctx.preflight.txns[txnIdx].word;
 }
 
@@ -423,6 +423,8 @@ __global__ void finalizeAccum(DeviceAccumContext* ctx, uint32_t lastCycle) {
 constexpr size_t kStepModeParallel = 0;
 constexpr size_t kStepModeSeqForward = 1;
 constexpr size_t kStepModeSeqReverse = 2;
+constexpr size_t kStepModeParallelTiled = 3;
+constexpr size_t kStepModeParallelBucketed = 4;
 
 extern "C" {
 
@@ -430,7 +432,7 @@ using namespace risc0::circuit::rv32im_v2::cuda;
 
 const char* risc0_circuit_rv32im_v2_cuda_witgen(uint32_t mode,
                                                 ExecBuffers* buffers,
-                                                PreflightTrace* preflight,
+                                                const PreflightTrace* preflight,
                                                 uint32_t lastCycle) {
   try {
     HostExecContext ctx(buffers, preflight, lastCycle);
@@ -438,6 +440,10 @@ const char* risc0_circuit_rv32im_v2_cuda_witgen(uint32_t mode,
     size_t split = preflight->tableSplitCycle;
 
     switch (mode) {
+    // Staging tiles and instruction buckets are CPU cache optimizations, on the GPU these are the
+    // same as parallel.
+    case kStepModeParallelTiled:
+    case kStepModeParallelBucketed:
     case kStepModeParallel: {
       auto cfg1 = getSimpleConfig(split);
       size_t phase2Count = lastCycle - split;
@@ -472,7 +478,7 @@ const char* risc0_circuit_rv32im_v2_cuda_witgen(uint32_t mode,
 }
 
 const char* risc0_circuit_rv32im_v2_cuda_accum(AccumBuffers* buffers,
-                                               PreflightTrace* preflight,
+                                               const PreflightTrace* preflight,
                                                uint32_t lastCycle) {
   try {
     HostAccumContext ctx(buffers, preflight, lastCycle);
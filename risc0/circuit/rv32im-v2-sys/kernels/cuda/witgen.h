@@ -38,11 +38,17 @@ using Val = Fp;
 using ExtVal = FpExt;
 
 struct ExecContext {
-  __device__ ExecContext(PreflightTrace& preflight, LookupTables& tables, size_t cycle)
-      : preflight(preflight), tables(tables), cycle(cycle) {}
-  PreflightTrace& preflight;
+  __device__ ExecContext(const PreflightTrace& preflight, LookupTables& tables, size_t cycle)
+      : preflight(preflight)
+      , tables(tables)
+      , cycle(cycle)
+      , txnIdx(preflight.cycles[cycle].txnIdx) {}
+  const PreflightTrace& preflight;
   LookupTables& tables;
   size_t cycle;
+  // The next memory transaction of this cycle.  The cursor lives here rather than in the
+  // preflight, so that executing a cycle leaves the preflight untouched and can be repeated.
+  uint32_t txnIdx;
 };
 
 struct BufferObj {
@@ -14,11 +14,16 @@
 
 #include "fp.h"
 #include "fpext.h"
+#include "poly_fp_lanes.h"
+#include "rou.h"
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
 #include <cstdio>
 #include <exception>
 #include <string.h>
+#include <vector>
 
 using namespace risc0;
 
@@ -26,8 +31,14 @@ namespace risc0::circuit::rv32im_v2 {
 
 FpExt poly_fp(size_t cycle, size_t steps, FpExt* poly_mix, Fp** args);
 
+// The evaluation domain is kInvRate times the size of the trace.
+constexpr size_t kInvRate = 4;
+constexpr size_t kLog2InvRate = 2;
+
 } // namespace risc0::circuit::rv32im_v2
 
+using namespace risc0::circuit::rv32im_v2;
+
 extern "C" const char* risc0_circuit_rv32im_v2_cpu_poly_fp(
     size_t cycle, size_t steps, FpExt* poly_mix, Fp** args, FpExt* result) {
   try {
@@ -37,3 +48,124 @@ extern "C" const char* risc0_circuit_rv32im_v2_cpu_poly_fp(
   }
   return nullptr;
 }
+
+#if defined(__AVX2__)
+
+namespace {
+
+using lanes::kLanes;
+
+// The args of poly_fp, in the order they are passed.
+enum Arg : size_t { kAccum, kData, kOut, kMix, kArgs };
+
+// Load kLanes consecutive rows of a column of the domain from row on, wrapping around the end of
+// the domain like the taps of poly_fp do.
+lanes::Fp loadRows(const Fp* col, size_t row, size_t domain) {
+  if (row + kLanes <= domain) {
+    return lanes::Fp::load(col + row);
+  }
+  Fp rows[kLanes];
+  for (size_t i = 0; i < kLanes; i++) {
+    rows[i] = col[(row + i) & (domain - 1)];
+  }
+  return lanes::Fp::load(rows);
+}
+
+// Evaluates lanes::poly_fp at kLanes consecutive cycles at a time.  The accum and data buffers are
+// repacked for each group of cycles, with each row that poly_fp taps loaded as a vector of kLanes
+// rows straight from the column.  The out and mix buffers and poly_mix are read at the same indexes
+// for every cycle, so they are broadcast to every lane once up front.
+class LaneEval {
+public:
+  LaneEval(Fp** args, const size_t* argLens, FpExt* polyMix, size_t polyMixLen, size_t domain)
+      : args(args), domain(domain), polyMix(polyMix, polyMix + polyMixLen) {
+    for (Arg arg : {kAccum, kData}) {
+      cols[arg] = argLens[arg] / domain;
+      packed[arg].resize(cols[arg] * lanes::kSteps);
+    }
+    for (Arg arg : {kOut, kMix}) {
+      packed[arg].assign(args[arg], args[arg] + argLens[arg]);
+    }
+    for (size_t arg = 0; arg < kArgs; arg++) {
+      laneArgs[arg] = packed[arg].data();
+    }
+  }
+
+  // Evaluate the cycles [cycle, cycle + kLanes) of the domain.
+  lanes::FpExt eval(size_t cycle) {
+    size_t mask = domain - 1;
+    for (Arg arg : {kAccum, kData}) {
+      for (size_t col = 0; col < cols[arg]; col++) {
+        lanes::Fp* dst = packed[arg].data() + col * lanes::kSteps;
+        for (size_t back : lanes::kTapBacks) {
+          size_t row = (cycle - kInvRate * back) & mask;
+          dst[lanes::kCycle - kInvRate * back] = loadRows(args[arg] + col * domain, row, domain);
+        }
+      }
+    }
+    return lanes::poly_fp(lanes::kCycle, lanes::kSteps, polyMix.data(), laneArgs);
+  }
+
+private:
+  Fp** args;
+  size_t domain;
+  size_t cols[kArgs] = {};
+  std::vector<lanes::Fp> packed[kArgs];
+  lanes::Fp* laneArgs[kArgs];
+  std::vector<lanes::FpExt> polyMix;
+};
+
+} // namespace
+
+#endif // __AVX2__
+
+// Evaluate the constraint polynomial divided by the zerofier at each point in [begin, end) of the
+// domain, writing the result to the four check columns.  With x = w^cycle for the 2^(po2 + 2)-th
+// root of unity w, the zerofier (3x)^(2^po2) - 1 is 3^(2^po2) * w^(cycle * 2^po2) - 1, and
+// w^(2^po2) is a 4th root of unity, so the zerofier only ever takes kInvRate values, which are
+// inverted once up front.  When built with AVX2, whole groups of kLanes cycles are evaluated in
+// SIMD lanes, and whatever is left over one cycle at a time.
+extern "C" const char*
+risc0_circuit_rv32im_v2_cpu_eval_check(Fp* check,
+                                       Fp** args,
+                                       [[maybe_unused]] const size_t* arg_lens,
+                                       FpExt* poly_mix,
+                                       [[maybe_unused]] size_t poly_mix_len,
+                                       size_t po2,
+                                       size_t domain,
+                                       size_t begin,
+                                       size_t end) {
+  try {
+    Fp shift = pow(Fp(3), size_t(1) << po2);
+    std::array<Fp, kInvRate> zerofierInv;
+    for (size_t i = 0; i < kInvRate; i++) {
+      zerofierInv[i] = inv(shift * pow(kRouFwd[kLog2InvRate], i) - Fp(1));
+    }
+    size_t cycle = begin;
+#if defined(__AVX2__)
+    if (end - begin >= kLanes) {
+      // kLanes is a multiple of kInvRate, so every group sees the zerofier in the same order.
+      static_assert(kLanes % kInvRate == 0);
+      Fp groupZerofierInv[kLanes];
+      for (size_t i = 0; i < kLanes; i++) {
+        groupZerofierInv[i] = zerofierInv[(begin + i) % kInvRate];
+      }
+      lanes::Fp laneZerofierInv = lanes::Fp::load(groupZerofierInv);
+      LaneEval laneEval(args, arg_lens, poly_mix, poly_mix_len, domain);
+      for (; cycle + kLanes <= end; cycle += kLanes) {
+        lanes::FpExt ret = laneEval.eval(cycle) * laneZerofierInv;
+        ret.store(check + cycle, domain);
+      }
+    }
+#endif
+    for (; cycle < end; cycle++) {
+      FpExt ret = poly_fp(cycle, domain, poly_mix, args) * zerofierInv[cycle % kInvRate];
+      for (size_t i = 0; i < 4; i++) {
+        check[i * domain + cycle] = ret.elems[i];
+      }
+    }
+  } catch (const std::exception& err) {
+    return strdup(err.what());
+  }
+  return nullptr;
+}
@@ -15,6 +15,7 @@
 #include "buffers.h"
 #include "fp.h"
 #include "fpext.h"
+#include "parallel_for.h"
 #include "preflight.h"
 #include "steps.h"
 #include "witgen.h"
@@ -28,7 +29,6 @@
 #endif
 
 #include "vendor/nvtx3/nvtx3.hpp"
-#include "vendor/poolstl.hpp"
 
 #if defined(__clang__)
 #pragma clang diagnostic pop
@@ -36,14 +36,17 @@
 #pragma GCC diagnostic pop
 #endif
 
+#include <algorithm>
 #include <array>
 #include <assert.h>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <iomanip>
 #include <iostream>
 #include <iterator>
+#include <numeric>
 #include <string.h>
 #include <vector>
 
@@ -83,8 +86,9 @@ std::array<uint32_t, 2> divide_rv32im(uint32_t numer, uint32_t denom, uint32_t s
 
 std::array<Val, 5> extern_getMemoryTxn(ExecContext& ctx, Val addrElem) {
   uint32_t addr = addrElem.asUInt32();
-  size_t txnIdx = ctx.preflight.cycles[ctx.cycle].txnIdx++;
-  const MemoryTransaction& txn = ctx.preflight.txns[txnIdx];
+  uint32_t txnIdx = ctx.txnIdx++;
+  ctx.preflight.checkTxnCycle(ctx.cycle, txnIdx);
+  const CompactTxn& txn = ctx.preflight.txn(txnIdx);
   // printf("getMemoryTxn(%lu, 0x%08x): txn(txnId: %zu, cycle: %u, addr: 0x%08x, word: 0x%08x)\n",
   //        ctx.cycle,
   //        addr,
@@ -93,11 +97,6 @@ std::array<Val, 5> extern_getMemoryTxn(ExecContext& ctx, Val addrElem) {
   //        txn.addr,
   //        txn.word);
 
-  if (txn.cycle / 2 != ctx.cycle) {
-    printf("txn.cycle: %u, ctx.cycle: %zu\n", txn.cycle, ctx.cycle);
-    throw std::runtime_error("txn cycle mismatch");
-  }
-
   if (txn.addr != addr) {
     printf("[%lu]: txn.addr: 0x%08x, addr: 0x%08x\n", ctx.cycle, txn.addr, addr);
     throw std::runtime_error("memory peek not in preflight");
@@ -141,7 +140,7 @@ void extern_memoryDelta(
 uint32_t extern_getDiffCount(ExecContext& ctx, Val cycle) {
   // printf("getDiffCount\n");
   uint32_t cycleU32 = cycle.asUInt32();
-  return ctx.preflight.cycles[cycleU32 / 2].diffCount[cycleU32 % 2];
+  return ctx.preflight.diffCount(cycleU32 / 2, cycleU32 % 2);
 }
 
 Val extern_isFirstCycle_0(ExecContext& ctx) {
@@ -186,41 +185,80 @@ void extern_print(ExecContext& ctx, Val v) {
 }
 
 std::array<Val, 2> extern_getMajorMinor(ExecContext& ctx) {
-  uint8_t major = ctx.preflight.cycles[ctx.cycle].major;
-  uint8_t minor = ctx.preflight.cycles[ctx.cycle].minor;
+  uint8_t major = ctx.preflight.major(ctx.cycle);
+  uint8_t minor = ctx.preflight.minor(ctx.cycle);
   return {major, minor};
 }
 
 Val extern_hostReadPrepare(ExecContext& ctx, Val fp, Val len) {
-  size_t txnIdx = ctx.preflight.cycles[ctx.cycle].txnIdx;
-  uint32_t word = ctx.preflight.txns[txnIdx].word;
+  size_t txnIdx = ctx.txnIdx;
+  uint32_t word = ctx.preflight.txn(txnIdx).word;
   // printf("[%lu]: hostReadPrepare(txnIdx: %zu, word: 0x%08x)\n", ctx.cycle, txnIdx, word);
   return word;
 }
 
 Val extern_hostWrite(ExecContext& ctx, Val fdVal, Val addrLow, Val addrHigh, Val lenVal) {
   std::cout << "hostWrite\n";
-  size_t txnIdx = ctx.preflight.cycles[ctx.cycle].txnIdx;
-  return ctx.preflight.txns[txnIdx].word;
+  size_t txnIdx = ctx.txnIdx;
+  return ctx.preflight.txn(txnIdx).word;
 }
 
 std::array<Val, 2> extern_nextPagingIdx(ExecContext& ctx) {
-  uint32_t pagingIdx = ctx.preflight.cycles[ctx.cycle].pagingIdx;
-  uint32_t machineMode = ctx.preflight.cycles[ctx.cycle].machineMode;
+  uint32_t pagingIdx = ctx.preflight.pagingIdx(ctx.cycle);
+  uint32_t machineMode = ctx.preflight.machineMode(ctx.cycle);
   // printf("nextPagingIdx: (0x%05x, %u)\n", pagingIdx, machineMode);
   return {pagingIdx, machineMode};
 }
 
 std::array<Val, 16> extern_bigIntExtern(ExecContext& ctx) {
   std::array<Val, 16> ret;
-  size_t bigintIdx = ctx.preflight.cycles[ctx.cycle].bigintIdx;
+  size_t bigintIdx = ctx.preflight.bigintIdx(ctx.cycle);
   for (size_t i = 0; i < 16; i++) {
-    ret[i] = ctx.preflight.bigintBytes[bigintIdx + i];
+    ret[i] = ctx.preflight.bigintByte(bigintIdx + i);
   }
   return ret;
 }
 
-void stepExec(ExecBuffers& buffers, PreflightTrace& preflight, LookupTables& tables, size_t cycle) {
+// Rough relative cost of a cycle by its major opcode, used as a scheduling hint so that stretches
+// of poseidon, sha and bigint cycles are not all handed to the same worker.  These only need to be
+// in the right ballpark, since workers steal from each other to even out the rest.
+constexpr uint8_t kMajorCost[16] = {
+    1, // MISC0
+    1, // MISC1
+    1, // MISC2
+    1, // MUL0
+    2, // DIV0
+    1, // MEM0
+    1, // MEM1
+    1, // CONTROL0
+    2, // ECALL0
+    4, // POSEIDON0
+    4, // POSEIDON1
+    4, // SHA0
+    4, // BIGINT0
+    1,
+    1,
+    1,
+};
+
+uint64_t cycleCost(const CompactPreflight& preflight, size_t cycle) {
+  return kMajorCost[preflight.major(cycle) & 0xf];
+}
+
+// The major and minor of a ControlTable cycle, see add_cycle_special in preflight.rs.
+constexpr uint8_t kMajorControlTable = 7;
+constexpr uint8_t kMinorControlTable = 6;
+
+// Whether a cycle is a ControlTable cycle, the only kind which reads the lookup counts.
+bool isTableCycle(const CompactPreflight& preflight, size_t cycle) {
+  return preflight.major(cycle) == kMajorControlTable &&
+         preflight.minor(cycle) == kMinorControlTable;
+}
+
+void stepExec(ExecBuffers& buffers,
+              const CompactPreflight& preflight,
+              LookupTables& tables,
+              size_t cycle) {
   // printf("stepExec: %zu\n", cycle);
   ExecContext ctx(preflight, tables, cycle);
   MutableBufObj data(buffers.data);
@@ -228,8 +266,219 @@ void stepExec(ExecBuffers& buffers, PreflightTrace& preflight, LookupTables& tab
   step_Top(ctx, &data, &global);
 }
 
+// The number of consecutive cycles each worker runs against a staging tile in the tiled step mode.
+// The tile also holds the row before the first cycle, which the circuit reads back, so it is sized
+// to the next power of two, twice this many rows.
+constexpr size_t kTileRows = 64;
+constexpr size_t kTileRowsPo2 = 7;
+static_assert(kTileRows + 1 <= (size_t(1) << kTileRowsPo2));
+
+// The number of columns moved together by the blocked transposes below.  Within a block of columns
+// the transpose walks the rows, so each row of the tile is a contiguous run of kTileCols elements,
+// and the kTileCols column streams of the buffer being walked stay in L1 until their cache lines
+// are used up.
+constexpr size_t kTileCols = 16;
+
+// The smallest shift with cols <= 1 << shift, the row stride of a tile.
+static size_t tileRowShift(size_t cols) {
+  size_t shift = 0;
+  while ((size_t(1) << shift) < cols) {
+    shift++;
+  }
+  return shift;
+}
+
+// Copy count rows of the column-major buffer starting at row first, which wraps around the end of
+// the buffer, into the first count rows of the row-major tile.
+static void
+loadTile(const Buffer<false>& buf, size_t first, size_t count, Fp* tile, size_t rowShift) {
+  size_t mask = buf.rows - 1;
+  for (size_t colBlock = 0; colBlock < buf.cols; colBlock += kTileCols) {
+    size_t colEnd = std::min(colBlock + kTileCols, buf.cols);
+    for (size_t row = 0; row < count; row++) {
+      const Fp* src = buf.buf + ((first + row) & mask);
+      Fp* dst = tile + (row << rowShift);
+      for (size_t col = colBlock; col < colEnd; col++) {
+        dst[col] = src[col * buf.rows];
+      }
+    }
+  }
+}
+
+// Copy the first count rows of a row-major tile back into rows [first, first + count) of the
+// column-major buffer, the inverse of loadTile.
+static void
+flushTile(Buffer<false>& buf, size_t first, size_t count, const Fp* tile, size_t rowShift) {
+  size_t mask = buf.rows - 1;
+  for (size_t colBlock = 0; colBlock < buf.cols; colBlock += kTileCols) {
+    size_t colEnd = std::min(colBlock + kTileCols, buf.cols);
+    for (size_t row = 0; row < count; row++) {
+      Fp* dst = buf.buf + ((first + row) & mask);
+      const Fp* src = tile + (row << rowShift);
+      for (size_t col = colBlock; col < colEnd; col++) {
+        dst[col * buf.rows] = src[col];
+      }
+    }
+  }
+}
+
+// Run cycles [begin, end) in order, staging all writes to the data buffer in a row-major tile.
+// The tile starts with the row before begin, so that the reads one row back from the first cycle
+// find it in the tile as well.
+void stepExecTile(ExecBuffers& buffers,
+                  const CompactPreflight& preflight,
+                  LookupTables& tables,
+                  size_t begin,
+                  size_t end) {
+  thread_local std::vector<Fp> tile;
+  size_t count = end - begin;
+  if (count > kTileRows) {
+    throw std::runtime_error("Too many cycles for a tile");
+  }
+  size_t rowShift = tileRowShift(buffers.data.cols);
+  tile.resize(size_t(1) << (kTileRowsPo2 + rowShift));
+  loadTile(buffers.data, begin - 1, count + 1, tile.data(), rowShift);
+  MutableBufObj data =
+      MutableBufObj::tile(buffers.data, tile.data(), begin - 1, kTileRowsPo2, rowShift);
+  GlobalBufObj global(buffers.global);
+  for (size_t cycle = begin; cycle < end; cycle++) {
+    ExecContext ctx(preflight, tables, cycle);
+    step_Top(ctx, &data, &global);
+  }
+  flushTile(buffers.data, begin, count, tile.data() + (size_t(1) << rowShift), rowShift);
+}
+
+// Run cycles [begin, end) in parallel, one tile of kTileRows cycles per task.
+void stepExecTiled(ExecBuffers& buffers,
+                   const CompactPreflight& preflight,
+                   LookupTables& tables,
+                   size_t begin,
+                   size_t end) {
+  size_t tiles = (end - begin + kTileRows - 1) / kTileRows;
+  parallelFor(0, tiles, [&](size_t tile) {
+    size_t first = begin + tile * kTileRows;
+    stepExecTile(buffers, preflight, tables, first, std::min(first + kTileRows, end));
+  });
+}
+
+// Run cycles [begin, end) in parallel, but ordered by instruction rather than by cycle.  A counting
+// sort on the preflight (major, minor) groups cycles which take the same path through step_Top, and
+// since parallelFor hands each worker contiguous ranges of the ordering, each worker mostly stays
+// in one instruction's code, which is much kinder to the i-cache and branch predictors.
+void stepExecBucketed(ExecBuffers& buffers,
+                      const CompactPreflight& preflight,
+                      LookupTables& tables,
+                      size_t begin,
+                      size_t end) {
+  auto key = [&](size_t cycle) {
+    return (size_t(preflight.major(cycle)) << 8) | preflight.minor(cycle);
+  };
+  std::vector<uint32_t> offsets((1 << 16) + 1);
+  for (size_t cycle = begin; cycle < end; cycle++) {
+    offsets[key(cycle) + 1]++;
+  }
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+  std::vector<uint32_t> order(end - begin);
+  for (size_t cycle = begin; cycle < end; cycle++) {
+    order[offsets[key(cycle)]++] = cycle;
+  }
+  parallelFor(
+      0,
+      order.size(),
+      [&](size_t i) { stepExec(buffers, preflight, tables, order[i]); },
+      [&](size_t i) { return cycleCost(preflight, order[i]); });
+}
+
+// Streaming witgen, which only keeps a ring of 2 * B rows of the data buffer.  Cycles are run a
+// window of B rows at a time: the window's half of the ring is cleared and injected with the values
+// the host computes for just those rows, its cycles are run in parallel, and once done the
+// (zeroized) rows are handed to the sink.  The circuit reads at most one row back, and since the
+// other half of the ring still holds the previous window, those reads see exactly what they would
+// in the full buffer.
+void stepExecStream(StreamBuffers& buffers,
+                    const CompactPreflight& preflight,
+                    LookupTables& tables,
+                    size_t lastCycle,
+                    WitgenInject inject,
+                    WitgenSink sink,
+                    void* user) {
+  Buffer<false>& ring = buffers.window;
+  size_t rows = buffers.rows;
+  size_t ringRows = ring.rows;
+  size_t mask = ringRows - 1;
+  size_t windowRows = ringRows / 2;
+  if (ringRows < 2 || (ringRows & mask) != 0 || ringRows > rows || rows % windowRows != 0) {
+    throw std::runtime_error("Streaming window must be a power of two no larger than the trace");
+  }
+
+  auto clearRows = [&](size_t begin, size_t count) {
+    parallelFor(0, ring.cols, [&](size_t col) {
+      std::fill_n(ring.buf + col * ringRows + begin, count, Fp::invalid());
+    });
+  };
+  auto injectRows = [&](size_t begin, size_t end) {
+    InjectedValues injected{};
+    if (inject(user, begin, end, &injected)) {
+      throw std::runtime_error("Witgen inject failed");
+    }
+    for (size_t i = 0; i < injected.count; i++) {
+      size_t offset = injected.offsets[i];
+      size_t col = offset / rows;
+      ring.buf[col * ringRows + ((offset % rows) & mask)] = injected.values[i];
+    }
+  };
+  auto zeroizeRows = [&](size_t begin, size_t count) {
+    parallelFor(0, ring.cols, [&](size_t col) {
+      Fp* ptr = ring.buf + col * ringRows + begin;
+      std::replace(ptr, ptr + count, Fp::invalid(), Fp(0));
+    });
+  };
+  auto exec = [&](size_t cycle) {
+    ExecContext ctx(preflight, tables, cycle);
+    MutableBufObj data(ring);
+    GlobalBufObj global(buffers.global);
+    step_Top(ctx, &data, &global);
+  };
+  auto cost = [&](size_t cycle) { return cycleCost(preflight, cycle); };
+  auto run = [&](size_t begin, size_t end) {
+    if (begin < end) {
+      parallelFor(begin, end, exec, cost);
+    }
+  };
+
+  // Cycle 0 reads back into the last row of the trace, which lands on the last row of the ring.
+  clearRows(0, ringRows);
+  injectRows(rows - 1, rows);
+
+  size_t split = preflight.tableSplitCycle;
+  bool merged = false;
+  for (size_t begin = 0; begin < rows; begin += windowRows) {
+    size_t end = begin + windowRows;
+    size_t ringBegin = begin & mask;
+    if (begin != 0) {
+      clearRows(ringBegin, windowRows);
+    }
+    injectRows(begin, end);
+
+    size_t stop = std::min(end, lastCycle);
+    if (!merged && split < end) {
+      run(begin, std::min(split, stop));
+      tables.merge();
+      merged = true;
+      run(std::max(split, begin), stop);
+    } else {
+      run(begin, stop);
+    }
+
+    zeroizeRows(ringBegin, windowRows);
+    if (sink(user, begin, windowRows, ring.buf + ringBegin, ringRows)) {
+      throw std::runtime_error("Witgen sink failed");
+    }
+  }
+}
+
 void stepAccum(AccumBuffers& buffers,
-               PreflightTrace& preflight,
+               const CompactPreflight& preflight,
                LookupTables& tables,
                size_t cycle) {
   ExecContext ctx(preflight, tables, cycle);
@@ -246,49 +495,221 @@ void stepAccum(AccumBuffers& buffers,
   //        buffers.accum.get(cycle, buffers.accum.cols - 1).asUInt32());
 }
 
+// Read an extension element of the mix buffer.
+ExtVal loadMix(Buffer<true>& mix, Reg reg) {
+  return ExtVal(mix.get(0, reg.col),
+                mix.get(0, reg.col + 1),
+                mix.get(0, reg.col + 2),
+                mix.get(0, reg.col + 3));
+}
+
+// The accum rows are produced a block at a time.  Each block computes its rows, scans its own
+// share of the running total and adds it to its other machine columns, all while its rows are still
+// in cache.  What is left is a carry, the running total through the block before, to be added to
+// every one of its rows.  A block adds its carry right away if it is known by then, which is most
+// of the time, and otherwise leaves it for a second pass over the blocks.
+constexpr size_t kAccumBlockRows = 1024;
+
+using AccumSum = std::array<Fp, 4>;
+
+// The carries into each block, extended in block order as the blocks finish, in whatever order
+// that is.  No block waits for another: each finished block counts itself in pending, and whichever
+// block counts in first extends the carries through every finished block in a row, and keeps going
+// until it has seen every block counted in meanwhile.
+class AccumCarries {
+public:
+  AccumCarries(size_t blocks) : sums(blocks), carries(blocks + 1), done(blocks) {}
+
+  // Record the sum of a block alone, once its rows are done.
+  void finish(size_t block, const AccumSum& sum) {
+    sums[block] = sum;
+    done[block].store(true, std::memory_order_release);
+    size_t seen = 1;
+    if (pending.fetch_add(seen, std::memory_order_acq_rel) != 0) {
+      // The block extending the carries will get to this one.
+      return;
+    }
+    while (true) {
+      while (frontier < sums.size() && done[frontier].load(std::memory_order_acquire)) {
+        for (size_t k = 0; k < 4; k++) {
+          carries[frontier + 1][k] = carries[frontier][k] + sums[frontier][k];
+        }
+        frontier++;
+        extended.store(frontier, std::memory_order_release);
+      }
+      size_t left = pending.fetch_sub(seen, std::memory_order_acq_rel) - seen;
+      if (left == 0) {
+        break;
+      }
+      seen = left;
+    }
+  }
+
+  // Whether the carry into block is known yet.
+  bool known(size_t block) const { return block <= extended.load(std::memory_order_acquire); }
+
+  // The running total through the block before, once known.
+  const AccumSum& carry(size_t block) const { return carries[block]; }
+
+  // The grand total, once every block has finished.
+  const AccumSum& total() const { return carries.back(); }
+
+private:
+  std::vector<AccumSum> sums;
+  std::vector<AccumSum> carries;
+  std::vector<std::atomic<bool>> done;
+  std::atomic<size_t> pending{0};
+  std::atomic<size_t> extended{0};
+  // Only touched by the block extending the carries.
+  size_t frontier = 0;
+};
+
+// The rows of block, clipped to the trace.
+std::pair<size_t, size_t> accumBlockRows(size_t block, size_t lastCycle) {
+  size_t begin = block * kAccumBlockRows;
+  return {begin, std::min(begin + kAccumBlockRows, lastCycle)};
+}
+
+// Compute and scan the rows of one block, on its own.  The last four columns end up holding the
+// running total from the start of the block, and every other machine column has the running total
+// through the row before, within the block, added to it.  Returns the sum of the block.
+AccumSum accumBlock(AccumBuffers& buffers,
+                    const CompactPreflight& preflight,
+                    LookupTables& tables,
+                    const AccumInverses& inverses,
+                    size_t begin,
+                    size_t end) {
+  {
+    AccumInverses::Scope scope(inverses);
+    for (size_t cycle = begin; cycle < end; cycle++) {
+      stepAccum(buffers, preflight, tables, cycle);
+    }
+  }
+
+  Buffer<false>& accum = buffers.accum;
+  size_t rows = accum.rows;
+  Fp* sumCols = accum.buf + (accum.cols - 4) * rows;
+  size_t machineColumns = (accum.cols - kUserAccumSplit) / 4;
+  AccumSum sum;
+  for (size_t k = 0; k < 4; k++) {
+    Fp* col = sumCols + k * rows;
+    for (size_t row = begin; row < end; row++) {
+      sum[k] += col[row];
+      col[row] = sum[k];
+    }
+    for (size_t j = 0; j < machineColumns - 1; j++) {
+      Fp* dst = accum.buf + (kUserAccumSplit + j * 4 + k) * rows;
+      for (size_t row = begin + 1; row < end; row++) {
+        dst[row] += col[row - 1];
+      }
+    }
+  }
+  return sum;
+}
+
+// Add the running total through the block before to every machine column of a block's rows.  The
+// first row of the trace is left for the caller, since its row before is the last one.
+void accumCarry(Buffer<false>& accum, size_t begin, size_t end, const AccumSum& carry) {
+  size_t rows = accum.rows;
+  Fp* sumCols = accum.buf + (accum.cols - 4) * rows;
+  size_t machineColumns = (accum.cols - kUserAccumSplit) / 4;
+  for (size_t k = 0; k < 4; k++) {
+    for (size_t j = 0; j < machineColumns - 1; j++) {
+      Fp* dst = accum.buf + (kUserAccumSplit + j * 4 + k) * rows;
+      for (size_t row = begin; row < end; row++) {
+        dst[row] += carry[k];
+      }
+    }
+    Fp* col = sumCols + k * rows;
+    for (size_t row = begin; row < end; row++) {
+      col[row] += carry[k];
+    }
+  }
+}
+
 } // namespace risc0::circuit::rv32im_v2::cpu
 
 constexpr size_t kStepModeParallel = 0;
 constexpr size_t kStepModeSeqForward = 1;
 constexpr size_t kStepModeSeqReverse = 2;
+constexpr size_t kStepModeParallelTiled = 3;
+constexpr size_t kStepModeParallelBucketed = 4;
 
 extern "C" {
 
 using namespace risc0;
 using namespace risc0::circuit::rv32im_v2::cpu;
 
+const char* risc0_circuit_rv32im_v2_cpu_preflight_alloc(const PreflightTrace* preflight,
+                                                       uint32_t lastCycle,
+                                                       CompactPreflight** out) {
+  try {
+    *out = new CompactPreflight(*preflight, lastCycle);
+  } catch (const std::exception& err) {
+    return strdup(err.what());
+  } catch (...) {
+    return strdup("Generic exception");
+  }
+  return nullptr;
+}
+
+void risc0_circuit_rv32im_v2_cpu_preflight_free(CompactPreflight* preflight) {
+  delete preflight;
+}
+
 const char* risc0_circuit_rv32im_v2_cpu_witgen(uint32_t mode,
                                                ExecBuffers* buffers,
-                                               PreflightTrace* preflight,
-                                               uint32_t lastCycle) {
-  LookupTables tables;
-  size_t split = preflight->tableSplitCycle;
+                                               const CompactPreflight* preflight) {
   try {
+    const CompactPreflight& compact = *preflight;
+    size_t lastCycle = compact.cycles();
+    LookupTables tables;
+    size_t split = compact.tableSplitCycle;
     switch (mode) {
     case kStepModeParallel: {
-      auto begin1 = poolstl::iota_iter<uint32_t>(0);
-      auto end1 = poolstl::iota_iter<uint32_t>(split);
-      std::for_each(poolstl::par, begin1, end1, [&](uint32_t cycle) {
-        stepExec(*buffers, *preflight, tables, cycle);
-      });
-
-      auto begin2 = poolstl::iota_iter<uint32_t>(split);
-      auto end2 = poolstl::iota_iter<uint32_t>(lastCycle);
-      std::for_each(poolstl::par, begin2, end2, [&](uint32_t cycle) {
-        stepExec(*buffers, *preflight, tables, cycle);
-      });
+      // The table cycles right after the split read the final counts, so they depend on every
+      // cycle before the split, but not on each other.  Rather than a barrier and a merge, they
+      // start as soon as the last cycle before the split returns, and each chunk of the counts is
+      // merged by the first table cycle to read it.  The ControlDone padding after them reads no
+      // counts, so it fills in the ramp-down of the cycles before the split.
+      size_t tableEnd = split;
+      while (tableEnd < lastCycle && isTableCycle(compact, tableEnd)) {
+        tableEnd++;
+      }
+      parallelForGated(
+          0,
+          split,
+          tableEnd,
+          lastCycle,
+          [&](size_t cycle) { stepExec(*buffers, compact, tables, cycle); },
+          [&](size_t cycle) { return cycleCost(compact, cycle); });
     } break;
+    case kStepModeParallelTiled:
+      stepExecTiled(*buffers, compact, tables, 0, split);
+      tables.merge();
+      stepExecTiled(*buffers, compact, tables, split, lastCycle);
+      break;
+    case kStepModeParallelBucketed:
+      stepExecBucketed(*buffers, compact, tables, 0, split);
+      tables.merge();
+      stepExecBucketed(*buffers, compact, tables, split, lastCycle);
+      break;
     case kStepModeSeqForward:
-      for (size_t cycle = 0; cycle < lastCycle; cycle++) {
-        stepExec(*buffers, *preflight, tables, cycle);
+      for (size_t cycle = 0; cycle < split; cycle++) {
+        stepExec(*buffers, compact, tables, cycle);
+      }
+      tables.merge();
+      for (size_t cycle = split; cycle < lastCycle; cycle++) {
+        stepExec(*buffers, compact, tables, cycle);
       }
       break;
     case kStepModeSeqReverse: {
       for (size_t i = split; i-- > 0;) {
-        stepExec(*buffers, *preflight, tables, i);
+        stepExec(*buffers, compact, tables, i);
       }
+      tables.merge();
       for (size_t i = lastCycle; i-- > split;) {
-        stepExec(*buffers, *preflight, tables, i);
+        stepExec(*buffers, compact, tables, i);
       }
     } break;
     }
@@ -300,56 +721,65 @@ const char* risc0_circuit_rv32im_v2_cpu_witgen(uint32_t mode,
   return nullptr;
 }
 
-const char* risc0_circuit_rv32im_v2_cpu_accum(AccumBuffers* buffers,
-                                              PreflightTrace* preflight,
-                                              uint32_t lastCycle) {
+const char* risc0_circuit_rv32im_v2_cpu_witgen_stream(StreamBuffers* buffers,
+                                                      const CompactPreflight* preflight,
+                                                      WitgenInject inject,
+                                                      WitgenSink sink,
+                                                      void* user) {
   try {
     LookupTables tables;
+    stepExecStream(*buffers, *preflight, tables, preflight->cycles(), inject, sink, user);
+  } catch (const std::exception& err) {
+    return strdup(err.what());
+  } catch (...) {
+    return strdup("Generic exception");
+  }
+  return nullptr;
+}
 
-    {
-      nvtx3::scoped_range range("phase1");
-      auto begin = poolstl::iota_iter<uint32_t>(0);
-      auto end = poolstl::iota_iter<uint32_t>(lastCycle);
-      std::for_each(poolstl::par, begin, end, [&](uint32_t cycle) {
-        stepAccum(*buffers, *preflight, tables, cycle);
-      });
-    }
-
-    buffers->accum.checked = false;
+const char* risc0_circuit_rv32im_v2_cpu_accum(AccumBuffers* buffers,
+                                              const CompactPreflight* preflight) {
+  try {
+    const CompactPreflight& compact = *preflight;
+    size_t lastCycle = compact.cycles();
+    LookupTables tables;
 
-    {
-      // prefix-sum
-      nvtx3::scoped_range range("phase2");
-      size_t rows = buffers->accum.rows;
-      for (size_t j = 0; j < 4; j++) {
-        size_t col = buffers->accum.cols - 4 + j;
-        Fp* itBegin = buffers->accum.buf + col * rows;
-        Fp* itEnd = itBegin + lastCycle;
-        // NOTE: poolstl does not support parallel inclusive_scan
-        std::inclusive_scan(itBegin, itEnd, itBegin);
+    nvtx3::scoped_range range("accum");
+    AccumInverses inverses(loadMix(buffers->mix, kLayoutMix.randomness.argU8.val),
+                           loadMix(buffers->mix, kLayoutMix.randomness.argU16.val),
+                           loadMix(buffers->mix, kLayoutMix.randomness._offset));
+    size_t blocks = (lastCycle + kAccumBlockRows - 1) / kAccumBlockRows;
+    AccumCarries carries(blocks);
+    std::vector<uint8_t> carried(blocks);
+    parallelFor(0, blocks, [&](size_t block) {
+      auto [begin, end] = accumBlockRows(block, lastCycle);
+      AccumSum sum = accumBlock(*buffers, compact, tables, inverses, begin, end);
+      carries.finish(block, sum);
+      if (carries.known(block)) {
+        accumCarry(buffers->accum, begin, end, carries.carry(block));
+        carried[block] = true;
       }
-    }
-
-    {
-      // apply totals
-      nvtx3::scoped_range range("phase3");
-      size_t machineColumns = (buffers->accum.cols - kUserAccumSplit) / 4;
-      auto begin = poolstl::iota_iter<uint32_t>(0);
-      auto end = poolstl::iota_iter<uint32_t>(lastCycle);
-      std::for_each(poolstl::par, begin, end, [&](uint32_t row) {
-        size_t back1 = (row + lastCycle - 1) % lastCycle;
-        std::array<Fp, 4> prev;
+    });
+    // Every carry is known now, so add the ones the first pass couldn't.
+    parallelFor(0, blocks, [&](size_t block) {
+      if (!carried[block]) {
+        auto [begin, end] = accumBlockRows(block, lastCycle);
+        accumCarry(buffers->accum, begin, end, carries.carry(block));
+      }
+    });
+
+    // The first row's previous row wraps around to the last, so it takes the grand total.
+    if (lastCycle) {
+      const AccumSum& total = carries.total();
+      Buffer<false>& accum = buffers->accum;
+      size_t machineColumns = (accum.cols - kUserAccumSplit) / 4;
+      for (size_t j = 0; j < machineColumns - 1; j++) {
         for (size_t k = 0; k < 4; k++) {
-          prev[k] = buffers->accum.get(back1, buffers->accum.cols - 4 + k);
+          accum.buf[(kUserAccumSplit + j * 4 + k) * accum.rows] += total[k];
         }
-        for (size_t j = 0; j < machineColumns - 1; j++) {
-          for (size_t k = 0; k < 4; k++) {
-            size_t col = kUserAccumSplit + j * 4 + k;
-            buffers->accum.set(row, col, buffers->accum.get(row, col) + prev[k]);
-          }
-        }
-      });
+      }
     }
+    buffers->accum.checked = false;
   } catch (const std::exception& err) {
     return strdup(err.what());
   } catch (...) {
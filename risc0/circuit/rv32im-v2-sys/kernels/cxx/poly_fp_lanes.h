@@ -0,0 +1,59 @@
+// Copyright 2025 RISC Zero, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/// \file
+/// The generated constraint polynomial, evaluated for several consecutive cycles at once.  The
+/// poly_fp_lanes_*.cpp files compile each rust_poly_fp_*.cpp a second time, inside the lanes
+/// namespace below, where Fp and FpExt name the vector types.  The generated code is straight-line
+/// arithmetic on those two names, so each of its operations then applies to every lane at once.
+///
+/// This is only built with AVX2, since without it FpVecNative is the portable FpVec, whose loops
+/// come out slower than the scalar poly_fp.
+
+#include "fpextvec.h"
+#include "fpvec.h"
+
+#include <cstddef>
+
+namespace risc0::circuit::rv32im_v2::lanes {
+
+using Fp = FpVecNative;
+using FpExt = FpExtVecNative;
+
+/// The number of cycles evaluated by each call of poly_fp.
+constexpr size_t kLanes = Fp::LANES;
+
+/// The back offsets, in cycles of the trace, at which the generated code taps the accum and data
+/// buffers.  These must be kept in step with rust_poly_fp_*.cpp when the circuit is regenerated:
+/// each is a B in an index of the form ((cycle - kInvRate * B) & mask).
+constexpr size_t kTapBacks[] = {0, 1, 2, 3, 4, 7, 15, 16, 68};
+
+/// The steps to evaluate poly_fp with, which is the number of rows in each column of the repacked
+/// accum and data buffers.  Only the rows that are tapped are filled in, so this need only be a
+/// power of two larger than the furthest tap back in rows.
+constexpr size_t kSteps = 512;
+
+/// The cycle to evaluate poly_fp at: the furthest tap back in rows, kInvRate * 68, so that no tap
+/// back from it wraps.
+constexpr size_t kCycle = 4 * 68;
+
+/// Like rv32im_v2::poly_fp, where lane i of every buffer and every result belongs to the i-th of
+/// kLanes consecutive cycles.  args[0] (accum) and args[1] (data) are read at rows
+/// c * kSteps + kCycle - 4 * B for column c and each B in kTapBacks, and args[2] (out),
+/// args[3] (mix) and poly_mix are read at constant indexes, as they are by the scalar version.
+FpExt poly_fp(size_t cycle, size_t steps, FpExt* poly_mix, Fp** args);
+
+} // namespace risc0::circuit::rv32im_v2::lanes
@@ -14,7 +14,16 @@
 
 #pragma once
 
+#include "parallel_for.h"
+
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
 
 namespace risc0::circuit::rv32im_v2::cpu {
 
@@ -49,4 +58,162 @@ struct PreflightTrace {
   uint32_t tableSplitCycle;
 };
 
+// The part of a MemoryTransaction read by witgen.  The transaction's cycle is implied by which
+// preflight cycle it belongs to, so it is only checked when the compact form is built.
+struct CompactTxn {
+  uint32_t addr;
+  uint32_t word;
+  uint32_t prevCycle;
+  uint32_t prevWord;
+};
+
+// A compact structure-of-arrays encoding of a PreflightTrace, holding only the fields witgen reads.
+// Each extern touches one or two fields of a cycle, so splitting them into separate narrow arrays
+// means a worker only streams in the bytes it uses, instead of a whole 36 byte PreflightCycle:
+//
+// * major, minor and machineMode are separate 8-bit arrays.
+// * txnIdx and bigintIdx only ever grow, so they are stored as a 32-bit base per block of
+//   kBlockCycles cycles plus a 16-bit offset per cycle.
+// * diffCount is almost always small, so it is stored in 16 bits, with the rare larger counts kept
+//   in a sorted side table.
+//
+// That is 15 bytes per cycle rather than 36, and 16 bytes per transaction rather than 20.
+//
+// The bigint bytes are copied as well, so once built it no longer refers to the trace.  It is built
+// once per segment, see risc0_circuit_rv32im_v2_cpu_preflight_alloc, and then shared by witgen and
+// accum.
+class CompactPreflight {
+public:
+  static constexpr size_t kBlockCycles = 64;
+
+  uint32_t tableSplitCycle;
+
+  CompactPreflight(const PreflightTrace& trace, size_t cycles)
+      : tableSplitCycle(trace.tableSplitCycle)
+      , bigintBytes(trace.bigintBytes, trace.bigintBytes + trace.bigintBytesLen)
+      , majors(cycles)
+      , minors(cycles)
+      , machineModes(cycles)
+      , pagingIdxs(cycles)
+      , txnBase((cycles + kBlockCycles - 1) / kBlockCycles)
+      , txnOffsets(cycles)
+      , bigintBase(txnBase.size())
+      , bigintOffsets(cycles)
+      , diffCounts(2 * cycles)
+      , txns(trace.txnsLen) {
+    for (size_t block = 0; block < txnBase.size(); block++) {
+      txnBase[block] = trace.cycles[block * kBlockCycles].txnIdx;
+      bigintBase[block] = trace.cycles[block * kBlockCycles].bigintIdx;
+    }
+    parallelFor(0, cycles, [&](size_t cycle) {
+      const PreflightCycle& pc = trace.cycles[cycle];
+      majors[cycle] = pc.major;
+      minors[cycle] = pc.minor;
+      machineModes[cycle] = pc.machineMode;
+      pagingIdxs[cycle] = pc.pagingIdx;
+
+      // The last transaction of a cycle must also be addressable relative to its block's base.
+      uint32_t txnEnd = (cycle + 1 < cycles) ? trace.cycles[cycle + 1].txnIdx : trace.txnsLen;
+      txnOffsets[cycle] = narrowOffset(pc.txnIdx, txnEnd, txnBase[cycle / kBlockCycles]);
+      bigintOffsets[cycle] =
+          narrowOffset(pc.bigintIdx, pc.bigintIdx, bigintBase[cycle / kBlockCycles]);
+
+      for (size_t i = 0; i < 2; i++) {
+        uint32_t count = pc.diffCount[i];
+        diffCounts[2 * cycle + i] = std::min<uint32_t>(count, kDiffOverflow);
+        if (count >= kDiffOverflow) {
+          std::lock_guard<std::mutex> lock(sideLock);
+          diffOverflow.emplace_back(2 * cycle + i, count);
+        }
+      }
+
+      for (uint32_t idx = pc.txnIdx; idx < std::min(txnEnd, trace.txnsLen); idx++) {
+        const MemoryTransaction& txn = trace.txns[idx];
+        txns[idx] = {txn.addr, txn.word, txn.prevCycle, txn.prevWord};
+        if (txn.cycle / 2 != cycle) {
+          std::lock_guard<std::mutex> lock(sideLock);
+          txnCycleMismatch.emplace_back(idx, txn.cycle);
+        }
+      }
+    });
+    std::sort(diffOverflow.begin(), diffOverflow.end());
+    std::sort(txnCycleMismatch.begin(), txnCycleMismatch.end());
+  }
+
+  size_t cycles() const { return majors.size(); }
+
+  uint8_t major(size_t cycle) const { return majors[cycle]; }
+  uint8_t minor(size_t cycle) const { return minors[cycle]; }
+  uint8_t machineMode(size_t cycle) const { return machineModes[cycle]; }
+  uint32_t pagingIdx(size_t cycle) const { return pagingIdxs[cycle]; }
+
+  uint32_t txnIdx(size_t cycle) const {
+    return txnBase[cycle / kBlockCycles] + txnOffsets[cycle];
+  }
+
+  uint32_t bigintIdx(size_t cycle) const {
+    return bigintBase[cycle / kBlockCycles] + bigintOffsets[cycle];
+  }
+
+  uint8_t bigintByte(size_t idx) const { return bigintBytes[idx]; }
+
+  uint32_t diffCount(size_t cycle, size_t i) const {
+    uint16_t count = diffCounts[2 * cycle + i];
+    if (count != kDiffOverflow) {
+      return count;
+    }
+    auto it = std::lower_bound(
+        diffOverflow.begin(), diffOverflow.end(), std::make_pair(uint32_t(2 * cycle + i), 0u));
+    return it->second;
+  }
+
+  const CompactTxn& txn(uint32_t idx) const { return txns[idx]; }
+
+  // Check that transaction idx was recorded by the given cycle.
+  void checkTxnCycle(size_t cycle, uint32_t idx) const {
+    size_t end = (cycle + 1 < majors.size()) ? txnIdx(cycle + 1) : txns.size();
+    if (idx >= end) {
+      // Transactions past the end of the cycle belong to a later one.
+      printf("txn: %u, ctx.cycle: %zu, end: %zu\n", idx, cycle, end);
+      throw std::runtime_error("txn cycle mismatch");
+    }
+    if (txnCycleMismatch.empty()) {
+      return;
+    }
+    auto it = std::lower_bound(
+        txnCycleMismatch.begin(), txnCycleMismatch.end(), std::make_pair(idx, 0u));
+    if (it != txnCycleMismatch.end() && it->first == idx) {
+      printf("txn.cycle: %u, ctx.cycle: %zu\n", it->second, cycle);
+      throw std::runtime_error("txn cycle mismatch");
+    }
+  }
+
+private:
+  static constexpr uint16_t kDiffOverflow = 0xffff;
+
+  std::vector<uint8_t> bigintBytes;
+  std::vector<uint8_t> majors;
+  std::vector<uint8_t> minors;
+  std::vector<uint8_t> machineModes;
+  std::vector<uint32_t> pagingIdxs;
+  std::vector<uint32_t> txnBase;
+  std::vector<uint16_t> txnOffsets;
+  std::vector<uint32_t> bigintBase;
+  std::vector<uint16_t> bigintOffsets;
+  std::vector<uint16_t> diffCounts;
+  std::vector<CompactTxn> txns;
+
+  // Rare entries which don't fit the compact arrays, sorted by key.
+  std::mutex sideLock;
+  std::vector<std::pair<uint32_t, uint32_t>> diffOverflow;
+  std::vector<std::pair<uint32_t, uint32_t>> txnCycleMismatch;
+
+  static uint16_t narrowOffset(uint32_t idx, uint32_t end, uint32_t base) {
+    if (end - base > 0xffff) {
+      throw std::runtime_error("Preflight block too large for the compact encoding");
+    }
+    return idx - base;
+  }
+};
+
 } // namespace risc0::circuit::rv32im_v2::cpu
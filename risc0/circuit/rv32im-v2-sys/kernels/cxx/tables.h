@@ -16,19 +16,54 @@
 
 #include "fp.h"
 
+#if defined(__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wmissing-braces"
+#elif defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-braces"
+#endif
+
+#include "vendor/poolstl.hpp"
+
+#if defined(__clang__)
+#pragma clang diagnostic pop
+#elif defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <cstdint>
 #include <cstdio>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <vector>
 
 namespace risc0::circuit::rv32im_v2::cpu {
 
+// The u8 and u16 lookup table counts.  lookupDelta is called concurrently by every witgen worker,
+// so rather than contending on a shared set of atomic counters each thread increments a private
+// shard.  The shards are summed into the shared counts a chunk of entries at a time, either all at
+// once by merge() or on the first lookupCurrent of each chunk.  Since the merge is an integer sum,
+// the final counts are identical to incrementing in place.
+//
+// The cycles that record deltas must all finish before any of the counts are read, so either
+// merge() is called between the two (i.e. at the table split), or the reads are only started once
+// every delta has returned.  A delta that arrives after its chunk has been merged would never be
+// counted, so it throws instead.
 struct LookupTables {
-  std::vector<std::atomic_uint32_t> tableU8;
-  std::vector<std::atomic_uint32_t> tableU16;
+  static constexpr size_t kSizeU8 = 1 << 8;
+  static constexpr size_t kSizeU16 = 1 << 16;
+
+  // Both tables in one allocation, the u8 table is at [0, kSizeU8) and the u16 table follows it.
+  using Counts = std::vector<uint32_t>;
 
-  LookupTables() : tableU8(1 << 8), tableU16(1 << 16) {}
+  Counts counts;
+
+  LookupTables() : counts(kSizeU8 + kSizeU16), id(nextId++) {}
 
   void lookupDelta(size_t cycle, Fp table, Fp index, Fp /*count*/) {
     uint32_t tableU32 = table.asUInt32();
@@ -45,11 +80,13 @@ struct LookupTables {
       throw std::runtime_error("u8/16 table error");
     }
     // printf("table = %u, index = %u\n", tableU32, indexU32);
-    if (tableU32 == 8) {
-      tableU8[indexU32]++;
-    } else {
-      tableU16[indexU32]++;
+    size_t entry = (tableU32 == 8) ? indexU32 : kSizeU8 + indexU32;
+    if (chunkMerged[entry / kMergeChunk].load(std::memory_order_relaxed)) {
+      // The shards of this chunk have already been summed, so the delta would never be counted.
+      printf("[%lu]: LOOKUP ERROR: table = %u, index = %u after merge\n", cycle, tableU32, indexU32);
+      throw std::runtime_error("Lookup delta after its table entries were merged");
     }
+    localShard()[entry]++;
   }
 
   Fp lookupCurrent(Fp table, Fp index) {
@@ -58,11 +95,89 @@ struct LookupTables {
       throw std::runtime_error("Invalid lookup table");
     }
     uint32_t indexU32 = index.asUInt32();
-    if (tableU32 == 8) {
-      return Fp(tableU8[indexU32]);
-    } else {
-      return Fp(tableU16[indexU32]);
+    size_t entry = (tableU32 == 8) ? indexU32 : kSizeU8 + indexU32;
+    mergeChunk(entry / kMergeChunk);
+    return Fp(counts[entry]);
+  }
+
+  // Add all the per-thread shards into counts, in parallel over the table entries.
+  void merge() {
+    if (shards.empty()) {
+      return;
+    }
+    auto begin = poolstl::iota_iter<size_t>(0);
+    auto end = poolstl::iota_iter<size_t>(kMergeChunks);
+    std::for_each(poolstl::par, begin, end, [&](size_t chunk) { mergeChunk(chunk); });
+  }
+
+private:
+  // The number of table entries summed together by one merge step.
+  static constexpr size_t kMergeChunk = 4096;
+  static constexpr size_t kMergeChunks = (kSizeU8 + kSizeU16 + kMergeChunk - 1) / kMergeChunk;
+
+  // Each LookupTables gets a unique id, so a thread's cached shard can't be mistaken for a shard
+  // of a different instance that happens to live at the same address.
+  static inline std::atomic<uint64_t> nextId{0};
+
+  // The number of instances whose shards a thread keeps at hand.  Witgen of concurrent segments
+  // interleaves a few instances on the same pool threads, and each miss allocates a new shard.
+  static constexpr size_t kShardCacheWays = 4;
+
+  struct ShardCache {
+    struct Way {
+      uint64_t id = UINT64_MAX;
+      Counts* shard = nullptr;
+    };
+    std::array<Way, kShardCacheWays> ways;
+    // The way to replace on the next miss, in round robin.
+    size_t next = 0;
+  };
+
+  uint64_t id;
+  std::mutex shardsMutex;
+  std::vector<std::unique_ptr<Counts>> shards;
+
+  std::array<std::once_flag, kMergeChunks> merged;
+  std::array<std::atomic<bool>, kMergeChunks> chunkMerged{};
+
+  Counts& localShard() {
+    thread_local ShardCache cache;
+    for (auto& way : cache.ways) {
+      if (way.id == id) {
+        return *way.shard;
+      }
     }
+    // The entry replaced may point at the shard of a destroyed instance, which is never read
+    // again since ids are not reused.
+    auto& way = cache.ways[cache.next];
+    cache.next = (cache.next + 1) % kShardCacheWays;
+    std::lock_guard<std::mutex> lock(shardsMutex);
+    shards.push_back(std::make_unique<Counts>(counts.size()));
+    way.id = id;
+    way.shard = shards.back().get();
+    return *way.shard;
+  }
+
+  // Sum the shards into one chunk of counts, the first time the chunk is needed.
+  void mergeChunk(size_t chunk) {
+    std::call_once(merged[chunk], [&] {
+      chunkMerged[chunk].store(true, std::memory_order_relaxed);
+      std::vector<Counts*> ready;
+      {
+        std::lock_guard<std::mutex> lock(shardsMutex);
+        for (auto& shard : shards) {
+          ready.push_back(shard.get());
+        }
+      }
+      size_t first = chunk * kMergeChunk;
+      size_t last = std::min(first + kMergeChunk, counts.size());
+      for (Counts* shard : ready) {
+        for (size_t i = first; i < last; i++) {
+          counts[i] += (*shard)[i];
+          (*shard)[i] = 0;
+        }
+      }
+    });
   }
 };
 
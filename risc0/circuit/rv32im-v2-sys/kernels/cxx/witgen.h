@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include "batch_inv.h"
 #include "buffers.h"
 #include "fp.h"
 #include "fpext.h"
@@ -29,6 +30,7 @@
 #include <iostream>
 #include <sstream>
 #include <string.h>
+#include <type_traits>
 #include <vector>
 
 namespace risc0::circuit::rv32im_v2::cpu {
@@ -38,6 +40,33 @@ struct ExecBuffers {
   Buffer<false> data;
 };
 
+// Host-computed values for some rows of the data buffer, each at its offset in the full rows x cols
+// buffer.
+struct InjectedValues {
+  const uint32_t* offsets;
+  const Fp* values;
+  size_t count;
+};
+
+// Buffers for streaming witgen.  Rather than the full data buffer of the given rows, window is a
+// ring of a power of two rows, of which half is filled per window while the other half still holds
+// the rows behind it.
+struct StreamBuffers {
+  Buffer<true> global;
+  Buffer<false> window;
+  size_t rows;
+};
+
+// Provides the injected values for the rows [begin, end) to streaming witgen, just before it runs
+// them.  The values are only read until the next call.  A nonzero return stops witgen.
+using WitgenInject = int (*)(void* user, size_t begin, size_t end, InjectedValues* out);
+
+// Receives each finished block of rows from streaming witgen: column c of the rows
+// [firstRow, firstRow + rows) is at block + c * colStride.  The block is only valid for the
+// duration of the call.  A nonzero return stops witgen.
+using WitgenSink =
+    int (*)(void* user, size_t firstRow, size_t rows, const Fp* block, size_t colStride);
+
 struct AccumBuffers {
   Buffer<false> data;
   Buffer<false> accum;
@@ -67,6 +96,65 @@ inline Val mod(Val a, Val b) {
 
 constexpr size_t EXT_SIZE = 4;
 
+// The inverses of the lookup denominators scale * v + offset for every v in [0, size), built with
+// a single batched inversion.  Most of the inversions done by the accum step are of U8 and U16
+// lookup denominators, which only take a few thousand distinct values over a whole trace, so
+// looking them up here replaces an exponentiation with a handful of multiplies.
+class LookupInverses {
+public:
+  LookupInverses(ExtVal scale, ExtVal offset, size_t size)
+      : scale(scale), offset(offset), invScale(inv(scale.elems[0])), inverses(size) {
+    for (size_t v = 0; v < size; v++) {
+      inverses[v] = scale * Val(v) + offset;
+    }
+    batchInvParallel(inverses.data(), size);
+  }
+
+  // If x is one of the denominators, set out to its inverse and return true.
+  bool find(ExtVal x, ExtVal& out) const {
+    Val v = (x.elems[0] - offset.elems[0]) * invScale;
+    if (v.asUInt32() >= inverses.size() || scale * v + offset != x) {
+      return false;
+    }
+    out = inverses[v.asUInt32()];
+    return true;
+  }
+
+private:
+  ExtVal scale;
+  ExtVal offset;
+  Val invScale;
+  std::vector<ExtVal> inverses;
+};
+
+// The lookup inverses of the U8 and U16 arguments.  While an AccumInverses::Scope is alive on a
+// thread, inv_0 on that thread serves matching denominators from it.
+class AccumInverses {
+public:
+  AccumInverses(ExtVal argU8, ExtVal argU16, ExtVal offset)
+      : u8(argU8, offset, 1 << 8), u16(argU16, offset, 1 << 16) {}
+
+  bool find(ExtVal x, ExtVal& out) const { return u16.find(x, out) || u8.find(x, out); }
+
+  class Scope {
+  public:
+    Scope(const AccumInverses& inverses) : prev(current()) { current() = &inverses; }
+    ~Scope() { current() = prev; }
+
+  private:
+    const AccumInverses* prev;
+  };
+
+  static const AccumInverses*& current() {
+    static thread_local const AccumInverses* inverses = nullptr;
+    return inverses;
+  }
+
+private:
+  LookupInverses u8;
+  LookupInverses u16;
+};
+
 // Built in field operations
 inline Val isz(Val x) {
   return Val(x == Val(0));
@@ -81,6 +169,12 @@ inline Val inv_0(Val x) {
 }
 
 inline ExtVal inv_0(ExtVal x) {
+  ExtVal ret;
+  if (const AccumInverses* inverses = AccumInverses::current()) {
+    if (inverses->find(x, ret)) {
+      return ret;
+    }
+  }
   return inv(x);
 }
 
@@ -94,11 +188,14 @@ inline Val inRange(Val low, Val mid, Val high) {
 }
 
 struct ExecContext {
-  ExecContext(PreflightTrace& preflight, LookupTables& tables, size_t cycle)
-      : preflight(preflight), tables(tables), cycle(cycle) {}
-  PreflightTrace& preflight;
+  ExecContext(const CompactPreflight& preflight, LookupTables& tables, size_t cycle)
+      : preflight(preflight), tables(tables), cycle(cycle), txnIdx(preflight.txnIdx(cycle)) {}
+  const CompactPreflight& preflight;
   LookupTables& tables;
   size_t cycle;
+  // The next memory transaction of this cycle.  The cursor lives here rather than in the
+  // preflight, so that executing a cycle leaves the preflight untouched and can be repeated.
+  uint32_t txnIdx;
 };
 
 // Define index type (used in back)
@@ -109,53 +206,177 @@ struct Reg {
   size_t col;
 };
 
-struct BufferObj {
-  virtual Val load(ExecContext& ctx, size_t col, size_t back) = 0;
-  virtual void store(ExecContext& ctx, size_t col, Val val) = 0;
-};
-
-struct MutableBufObj : public BufferObj {
-  MutableBufObj(Buffer<false>& buf, size_t zeroBack = 0) : buf(buf), zeroBack(zeroBack) {}
+// Buffer checking policy.  Checked builds throw on a read of an unset (Fp::invalid()) element and
+// on a write that conflicts with an existing value, whenever the buffer's runtime 'checked' flag is
+// set.  Production builds can define RISC0_WITGEN_UNCHECKED to compile these comparisons out.
+#if defined(RISC0_WITGEN_UNCHECKED)
+constexpr bool kCheckedBuffers = false;
+#else
+constexpr bool kCheckedBuffers = true;
+#endif
 
-  Val load(ExecContext& ctx, size_t col, size_t back) override {
+// A non-virtual view of a column-major Buffer, so that every LOAD and STORE in the generated step
+// code inlines.  Global buffers are treated as a single row (rowMask == 0), which lets both kinds
+// share the same code.  Mutable buffers have a power of two number of rows, so wrapping 'back' past
+// row 0 is a mask rather than a modulo.
+//
+// The same view can also stand in for a block of rows staged in a row-major tile (see
+// MutableBufObj::tile), so that a worker running a block of consecutive cycles writes into a small
+// cache-resident tile instead of scattering every store across the column-major buffer.  Element
+// (row, col) is at buf + col * colStride + (((row - rowBase) & rowMask) << rowShift): a plain
+// buffer has a column stride of its rows and a row shift of 0, and a tile has a column stride of 1
+// and rows padded to a power of two.  Both go through the same arithmetic, so neither pays a
+// branch for the other.
+template <bool Checked> struct BufferObjT {
+  Val load(ExecContext& ctx, size_t col, size_t back) {
+    assert(!isGlobal || back == 0);
     if (zeroBack && col > zeroBack && back > 0) {
       return 0;
     }
-    size_t backRow = (buf.rows + ctx.cycle - back) % buf.rows;
-    return buf.get(backRow, col);
+    size_t row = ctx.cycle - back;
+    Val ret = *elem(row, col);
+    if constexpr (Checked) {
+      if (ret == Fp::invalid() && checked) {
+        invalidRead(row, col);
+      }
+    }
+    return ret;
+  }
+
+  void store(ExecContext& ctx, size_t col, Val val) {
+    size_t row = ctx.cycle;
+    Val* ptr = elem(row, col);
+    if constexpr (Checked) {
+      if (*ptr != Fp::invalid() && *ptr != val && checked) {
+        inconsistentSet(row, col, val, *ptr);
+      }
+    }
+    *ptr = val;
   }
 
-  void store(ExecContext& ctx, size_t col, Val val) override {
-    return buf.set(ctx.cycle, col, val);
+protected:
+  BufferObjT(Fp* buf,
+             size_t colStride,
+             size_t rowShift,
+             size_t rowBase,
+             size_t rowMask,
+             size_t traceMask,
+             bool checked,
+             bool isGlobal,
+             size_t zeroBack)
+      : buf(buf)
+      , colStride(colStride)
+      , rowShift(rowShift)
+      , rowBase(rowBase)
+      , rowMask(rowMask)
+      , traceMask(traceMask)
+      , zeroBack(zeroBack)
+      , checked(checked)
+      , isGlobal(isGlobal) {}
+
+  Val* elem(size_t row, size_t col) {
+    return buf + col * colStride + (((row - rowBase) & rowMask) << rowShift);
   }
 
-  Buffer<false>& buf;
+private:
+  Fp* buf;
+  size_t colStride;
+  size_t rowShift;
+  size_t rowBase;
+  size_t rowMask;
+  // The row mask of the whole buffer, which only serves to report rows in errors.
+  size_t traceMask;
   size_t zeroBack;
+  bool checked;
+  bool isGlobal;
+
+  [[noreturn]] __attribute__((noinline)) void invalidRead(size_t row, size_t col) {
+    printf("get(row: %zu, col: %zu) -> 0x%08x\n", row & traceMask, col, Fp::invalid().asRaw());
+    throw std::runtime_error("Read of unset value");
+  }
+
+  [[noreturn]] __attribute__((noinline)) void
+  inconsistentSet(size_t row, size_t col, Val val, Val cur) {
+    const char* name = isGlobal ? "setGlobal" : "set";
+    printf("%s(row: %zu, col: %zu, val: 0x%08x) cur: 0x%08x\n",
+           name,
+           row & traceMask,
+           col,
+           val.asUInt32(),
+           cur.asUInt32());
+    throw std::runtime_error("Inconsistent set");
+  }
 };
 
-using MutableBuf = MutableBufObj*;
+using BufferObj = BufferObjT<kCheckedBuffers>;
 
-struct GlobalBufObj : public BufferObj {
-  GlobalBufObj(Buffer<true>& buf) : buf(buf) {}
+struct MutableBufObj : public BufferObj {
+  MutableBufObj(Buffer<false>& buf, size_t zeroBack = 0)
+      : BufferObj(buf.buf,
+                  buf.rows,
+                  0,
+                  0,
+                  checkRows(buf.rows),
+                  buf.rows - 1,
+                  buf.checked,
+                  false,
+                  zeroBack) {}
+
+  /// A view of buf in which rows [first, first + (1 << tileRowsPo2)) are instead read from and
+  /// written to tile, which holds them row-major with 1 << rowShift elements per row, starting
+  /// with row first.  Rows wrap around the end of buf, as they do for buf itself.  Any other rows
+  /// land on some row of the tile as well, so every row a caller touches must be in range.  The
+  /// caller is responsible for filling the tile from the buffer beforehand and flushing it back
+  /// afterwards.
+  static MutableBufObj
+  tile(Buffer<false>& buf, Fp* tile, size_t first, size_t tileRowsPo2, size_t rowShift) {
+    checkRows(buf.rows);
+    return MutableBufObj(tile,
+                         1,
+                         rowShift,
+                         first,
+                         (size_t(1) << tileRowsPo2) - 1,
+                         buf.rows - 1,
+                         buf.checked,
+                         false,
+                         0);
+  }
 
-  Val load(ExecContext& ctx, size_t col, size_t back) override {
-    assert(back == 0);
-    return buf.get(0, col);
+private:
+  using BufferObj::BufferObj;
+
+  static size_t checkRows(size_t rows) {
+    if (rows == 0 || (rows & (rows - 1)) != 0) {
+      throw std::runtime_error("Mutable buffer rows must be a power of two");
+    }
+    return rows - 1;
   }
+};
 
-  void store(ExecContext& ctx, size_t col, Val val) override { return buf.set(0, col, val); }
+using MutableBuf = MutableBufObj*;
 
-  Buffer<true>& buf;
+struct GlobalBufObj : public BufferObj {
+  GlobalBufObj(Buffer<true>& buf)
+      : BufferObj(buf.buf, buf.rows, 0, 0, 0, 0, buf.checked, true, 0) {}
 };
 
 using GlobalBuf = GlobalBufObj*;
 
+// A layout bound to the buffer it describes.  Layouts are constexpr trees of column numbers (see
+// layout.cpp.inc), and the generated step code walks them with LAYOUT_LOOKUP.  Large layouts are
+// held by reference into those constant trees, but leaf layouts which are just a column number
+// (Reg, NondetRegLayout, ...) are held by value.  That way a leaf arrives at the function which
+// loads or stores it as an immediate or a register rather than as a pointer to be dereferenced, and
+// when the root layout is known (e.g. BIND_LAYOUT(kLayout_Top, ...)) the compiler folds the whole
+// chain of lookups into a constant column.
 template <typename T> struct BoundLayout {
-  BoundLayout(const T& layout, BufferObj* buf) : layout(layout), buf(buf) {}
+  using Storage = std::conditional_t<(sizeof(T) <= sizeof(size_t)), const T, const T&>;
+
+  constexpr BoundLayout(const T& layout, BufferObj* buf) : layout(layout), buf(buf) {}
   BoundLayout() = default;
-  BoundLayout(const BoundLayout&) = default;
+  constexpr BoundLayout(const BoundLayout&) = default;
 
-  const T& layout;
+  Storage layout;
   BufferObj* buf = nullptr;
 };
 
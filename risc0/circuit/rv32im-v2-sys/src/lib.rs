@@ -58,6 +58,10 @@ pub struct RawPreflightTrace {
     pub table_split_cycle: u32,
 }
 
+/// The compact copy of a [RawPreflightTrace] read by the CPU kernels, see
+/// [risc0_circuit_rv32im_v2_cpu_preflight_alloc].
+pub enum RawCompactPreflight {}
+
 #[repr(C)]
 pub struct RawBuffer {
     pub buf: *const BabyBearElem,
@@ -72,6 +76,40 @@ pub struct RawExecBuffers {
     pub data: RawBuffer,
 }
 
+#[repr(C)]
+pub struct RawInjectedValues {
+    pub offsets: *const u32,
+    pub values: *const BabyBearElem,
+    pub count: usize,
+}
+
+#[repr(C)]
+pub struct RawStreamBuffers {
+    pub global: RawBuffer,
+    pub window: RawBuffer,
+    pub rows: usize,
+}
+
+/// Provides the injected values for the rows `begin..end` to streaming witgen, see
+/// [risc0_circuit_rv32im_v2_cpu_witgen_stream]. They are only read until the next call. A nonzero
+/// return stops witgen.
+pub type RawWitgenInject = unsafe extern "C" fn(
+    user: *mut std::os::raw::c_void,
+    begin: usize,
+    end: usize,
+    out: *mut RawInjectedValues,
+) -> std::os::raw::c_int;
+
+/// Receives each finished block of rows from streaming witgen, see
+/// [risc0_circuit_rv32im_v2_cpu_witgen_stream]. A nonzero return stops witgen.
+pub type RawWitgenSink = unsafe extern "C" fn(
+    user: *mut std::os::raw::c_void,
+    first_row: usize,
+    rows: usize,
+    block: *const BabyBearElem,
+    col_stride: usize,
+) -> std::os::raw::c_int;
+
 #[repr(C)]
 pub struct RawAccumBuffers {
     pub data: RawBuffer,
@@ -81,17 +119,34 @@ pub struct RawAccumBuffers {
 }
 
 extern "C" {
+    /// Build the compact copy of the first `cycles` cycles of `preflight`, which witgen and accum
+    /// then share. It keeps no pointers into `preflight`, so the trace may be released once this
+    /// returns. Release the copy with [risc0_circuit_rv32im_v2_cpu_preflight_free].
+    pub fn risc0_circuit_rv32im_v2_cpu_preflight_alloc(
+        preflight: *const RawPreflightTrace,
+        cycles: u32,
+        out: *mut *const RawCompactPreflight,
+    ) -> *const std::os::raw::c_char;
+
+    pub fn risc0_circuit_rv32im_v2_cpu_preflight_free(preflight: *const RawCompactPreflight);
+
     pub fn risc0_circuit_rv32im_v2_cpu_witgen(
         mode: u32,
         buffers: *const RawExecBuffers,
-        preflight: *const RawPreflightTrace,
-        cycles: u32,
+        preflight: *const RawCompactPreflight,
+    ) -> *const std::os::raw::c_char;
+
+    pub fn risc0_circuit_rv32im_v2_cpu_witgen_stream(
+        buffers: *const RawStreamBuffers,
+        preflight: *const RawCompactPreflight,
+        inject: RawWitgenInject,
+        sink: RawWitgenSink,
+        user: *mut std::os::raw::c_void,
     ) -> *const std::os::raw::c_char;
 
     pub fn risc0_circuit_rv32im_v2_cpu_accum(
         buffers: *const RawAccumBuffers,
-        preflight: *const RawPreflightTrace,
-        cycles: u32,
+        preflight: *const RawCompactPreflight,
     ) -> *const std::os::raw::c_char;
 
     pub fn risc0_circuit_rv32im_v2_cpu_poly_fp(
@@ -101,6 +156,18 @@ extern "C" {
         args_ptr: *const *const BabyBearElem,
         result: *mut BabyBearExtElem,
     ) -> *const std::os::raw::c_char;
+
+    pub fn risc0_circuit_rv32im_v2_cpu_eval_check(
+        check: *mut BabyBearElem,
+        args_ptr: *const *const BabyBearElem,
+        arg_lens: *const usize,
+        poly_mixs: *const BabyBearExtElem,
+        poly_mixs_len: usize,
+        po2: usize,
+        domain: usize,
+        begin: usize,
+        end: usize,
+    ) -> *const std::os::raw::c_char;
 }
 
 #[cfg(feature = "cuda")]
@@ -12,20 +12,26 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-use std::rc::Rc;
+use std::{
+    os::raw::{c_int, c_void},
+    rc::Rc,
+    sync::{Mutex, OnceLock},
+};
 
 use anyhow::Result;
 use rayon::prelude::*;
 use risc0_circuit_rv32im_v2_sys::{
-    risc0_circuit_rv32im_v2_cpu_accum, risc0_circuit_rv32im_v2_cpu_poly_fp,
-    risc0_circuit_rv32im_v2_cpu_witgen, RawAccumBuffers, RawBuffer, RawExecBuffers,
-    RawPreflightTrace,
+    risc0_circuit_rv32im_v2_cpu_accum, risc0_circuit_rv32im_v2_cpu_eval_check,
+    risc0_circuit_rv32im_v2_cpu_preflight_alloc, risc0_circuit_rv32im_v2_cpu_preflight_free,
+    risc0_circuit_rv32im_v2_cpu_witgen, risc0_circuit_rv32im_v2_cpu_witgen_stream, RawAccumBuffers,
+    RawBuffer, RawCompactPreflight, RawExecBuffers, RawInjectedValues, RawPreflightTrace,
+    RawStreamBuffers,
 };
 use risc0_core::scope;
 use risc0_sys::ffi_wrap;
 use risc0_zkp::{
-    core::{hash::poseidon2::Poseidon2HashSuite, log2_ceil},
-    field::{map_pow, Elem, ExtElem as _, RootsOfUnity as _},
+    core::hash::poseidon2::Poseidon2HashSuite,
+    field::{map_pow, Elem},
     hal::{cpu::CpuBuffer, AccumPreflight, CircuitHal},
     INV_RATE,
 };
@@ -37,15 +43,103 @@ use super::{
 use crate::{
     prove::{witgen::preflight::PreflightTrace, GLOBAL_MIX, GLOBAL_OUT},
     zirgen::{
-        circuit::{CircuitField, ExtVal, Val, REGISTER_GROUP_ACCUM, REGISTER_GROUP_DATA},
+        circuit::{
+            CircuitField, ExtVal, Val, REGCOUNT_DATA, REGISTER_GROUP_ACCUM, REGISTER_GROUP_DATA,
+        },
         info::POLY_MIX_POWERS,
     },
 };
 
 type CpuHal = risc0_zkp::hal::cpu::CpuHal<CircuitField>;
 
+/// The number of points of the domain evaluated by each call of the native eval_check.
+const EVAL_CHECK_CHUNK: usize = 1 << 12;
+
+/// The stack size of the threads that run the native eval_check.  It evaluates poly_fp over SIMD
+/// lanes, where each of the nested generated functions keeps hundreds of KiB of vectors on the
+/// stack, more in all than the 2 MiB that rayon gives its threads by default.
+const EVAL_CHECK_STACK_SIZE: usize = 16 << 20;
+
+/// The thread pool that runs the native eval_check, see [EVAL_CHECK_STACK_SIZE].
+///
+/// Its threads only run while the caller waits in [rayon::ThreadPool::install], so it is sized to
+/// the pool of the first caller, the global pool unless it is called from another, rather than to
+/// the number of CPUs. That keeps a host which limits the global pool, e.g. with
+/// `RAYON_NUM_THREADS`, at the same parallelism here. The threads stay parked between proofs, and
+/// only reserve their stacks.
+fn eval_check_pool() -> &'static rayon::ThreadPool {
+    static POOL: OnceLock<rayon::ThreadPool> = OnceLock::new();
+    POOL.get_or_init(|| {
+        rayon::ThreadPoolBuilder::new()
+            .num_threads(rayon::current_num_threads())
+            .thread_name(|i| format!("eval_check-{i}"))
+            .stack_size(EVAL_CHECK_STACK_SIZE)
+            .build()
+            .unwrap()
+    })
+}
+
+/// The compact copy of a [PreflightTrace] read by the CPU kernels. It holds everything they read
+/// from the trace, so it is built once per segment and shared by witgen and accum.
+pub(crate) struct CompactPreflight {
+    raw: *const RawCompactPreflight,
+    cycles: usize,
+}
+
+// The native copy is never written once it is built.
+unsafe impl Send for CompactPreflight {}
+unsafe impl Sync for CompactPreflight {}
+
+impl CompactPreflight {
+    pub(crate) fn new(preflight: &PreflightTrace) -> Result<Self> {
+        scope!("compact_preflight");
+        let cycles = preflight.cycles.len();
+        let trace = RawPreflightTrace {
+            cycles: preflight.cycles.as_ptr(),
+            txns: preflight.txns.as_ptr(),
+            bigint_bytes: preflight.bigint_bytes.as_ptr(),
+            txns_len: preflight.txns.len() as u32,
+            bigint_bytes_len: preflight.bigint_bytes.len() as u32,
+            table_split_cycle: preflight.table_split_cycle,
+        };
+        let mut raw = std::ptr::null();
+        ffi_wrap(|| unsafe {
+            risc0_circuit_rv32im_v2_cpu_preflight_alloc(&trace, cycles as u32, &mut raw)
+        })?;
+        Ok(Self { raw, cycles })
+    }
+}
+
+impl Drop for CompactPreflight {
+    fn drop(&mut self) {
+        unsafe { risc0_circuit_rv32im_v2_cpu_preflight_free(self.raw) };
+    }
+}
+
+/// Identifies the [PreflightTrace] that a [CompactPreflight] was built from, by the addresses and
+/// lengths of the vectors it copies, which are fixed for as long as the trace is borrowed.
+#[derive(Clone, Copy, PartialEq, Eq)]
+struct TraceKey([usize; 6]);
+
+impl TraceKey {
+    fn new(preflight: &PreflightTrace) -> Self {
+        Self([
+            preflight.cycles.as_ptr() as usize,
+            preflight.cycles.len(),
+            preflight.txns.as_ptr() as usize,
+            preflight.txns.len(),
+            preflight.bigint_bytes.as_ptr() as usize,
+            preflight.bigint_bytes.len(),
+        ])
+    }
+}
+
 #[derive(Default)]
-pub struct CpuCircuitHal;
+pub struct CpuCircuitHal {
+    /// The compact copy of the trace that witgen last read, which step_accum takes over when it is
+    /// called with the same trace, rather than building its own.
+    compact: Mutex<Option<(TraceKey, CompactPreflight)>>,
+}
 
 impl CircuitWitnessGenerator<CpuHal> for CpuCircuitHal {
     fn generate_witness(
@@ -56,8 +150,9 @@ impl CircuitWitnessGenerator<CpuHal> for CpuCircuitHal {
         data: &MetaBuffer<CpuHal>,
     ) -> Result<()> {
         scope!("cpu_witgen");
-        let cycles = preflight.cycles.len();
-        tracing::debug!("witgen: {cycles}");
+        let key = TraceKey::new(preflight);
+        let preflight = CompactPreflight::new(preflight)?;
+        tracing::debug!("witgen: {}", preflight.cycles);
         let global_buf = global.buf.as_slice();
         let data_buf = data.buf.as_slice();
         let buffers = RawExecBuffers {
@@ -74,17 +169,162 @@ impl CircuitWitnessGenerator<CpuHal> for CpuCircuitHal {
                 checked: data.checked,
             },
         };
-        let preflight = RawPreflightTrace {
-            cycles: preflight.cycles.as_ptr(),
-            txns: preflight.txns.as_ptr(),
-            bigint_bytes: preflight.bigint_bytes.as_ptr(),
-            txns_len: preflight.txns.len() as u32,
-            bigint_bytes_len: preflight.bigint_bytes.len() as u32,
-            table_split_cycle: preflight.table_split_cycle,
-        };
         ffi_wrap(|| unsafe {
-            risc0_circuit_rv32im_v2_cpu_witgen(mode as u32, &buffers, &preflight, cycles as u32)
-        })
+            risc0_circuit_rv32im_v2_cpu_witgen(mode as u32, &buffers, preflight.raw)
+        })?;
+        *self.compact.lock().unwrap() = Some((key, preflight));
+        Ok(())
+    }
+}
+
+/// A block of finished rows of the data buffer, handed to the sink of
+/// [stream_witness](crate::prove::stream_witness).
+pub struct WitnessBlock<'a> {
+    /// The first row of the data buffer in this block.
+    pub first_row: usize,
+    /// The number of rows in this block.
+    pub rows: usize,
+    buf: &'a [Val],
+    col_stride: usize,
+}
+
+impl WitnessBlock<'_> {
+    /// The rows of this block in column `col` of the data buffer.
+    pub fn column(&self, col: usize) -> &[Val] {
+        let start = col * self.col_stride;
+        &self.buf[start..start + self.rows]
+    }
+}
+
+/// Host-computed values for some rows of the data buffer, each at its offset in the full
+/// `cycles x REGCOUNT_DATA` buffer.
+pub(crate) struct InjectedValues {
+    pub offsets: Vec<u32>,
+    pub values: Vec<Val>,
+}
+
+struct StreamState<I, F> {
+    inject: I,
+    sink: F,
+    injected: InjectedValues,
+    err: Option<anyhow::Error>,
+}
+
+unsafe extern "C" fn witgen_inject<I, F>(
+    user: *mut c_void,
+    begin: usize,
+    end: usize,
+    out: *mut RawInjectedValues,
+) -> c_int
+where
+    I: FnMut(usize, usize) -> Result<InjectedValues>,
+{
+    let state = &mut *(user as *mut StreamState<I, F>);
+    match (state.inject)(begin, end) {
+        Ok(injected) => {
+            // Kept in the state, since witgen reads it after this returns.
+            state.injected = injected;
+            *out = RawInjectedValues {
+                offsets: state.injected.offsets.as_ptr(),
+                values: state.injected.values.as_ptr(),
+                count: state.injected.offsets.len(),
+            };
+            0
+        }
+        Err(err) => {
+            state.err = Some(err);
+            1
+        }
+    }
+}
+
+unsafe extern "C" fn witgen_sink<I, F>(
+    user: *mut c_void,
+    first_row: usize,
+    rows: usize,
+    block: *const Val,
+    col_stride: usize,
+) -> c_int
+where
+    F: FnMut(&WitnessBlock) -> Result<()>,
+{
+    let state = &mut *(user as *mut StreamState<I, F>);
+    let buf = std::slice::from_raw_parts(block, (REGCOUNT_DATA - 1) * col_stride + rows);
+    let block = WitnessBlock {
+        first_row,
+        rows,
+        buf,
+        col_stride,
+    };
+    match (state.sink)(&block) {
+        Ok(()) => 0,
+        Err(err) => {
+            state.err = Some(err);
+            1
+        }
+    }
+}
+
+impl CpuCircuitHal {
+    /// Generate the `rows` rows of the data buffer a window of `window_rows` rows at a time,
+    /// handing each finished window to `sink` in order instead of filling a full
+    /// `rows x REGCOUNT_DATA` buffer. Only `2 * window_rows` rows are held at once. Before a
+    /// window's cycles run, `inject` is called with its range of rows, and returns the
+    /// host-computed values which would otherwise be scattered into the data buffer before witgen.
+    pub(crate) fn stream_witness<I, F>(
+        &self,
+        preflight: &CompactPreflight,
+        global: &MetaBuffer<CpuHal>,
+        rows: usize,
+        window_rows: usize,
+        inject: I,
+        sink: F,
+    ) -> Result<()>
+    where
+        I: FnMut(usize, usize) -> Result<InjectedValues>,
+        F: FnMut(&WitnessBlock) -> Result<()>,
+    {
+        scope!("cpu_witgen_stream");
+        tracing::debug!("witgen_stream: {}, window: {window_rows}", preflight.cycles);
+        let global_buf = global.buf.as_slice();
+        let mut window = vec![Val::INVALID; 2 * window_rows * REGCOUNT_DATA];
+        let buffers = RawStreamBuffers {
+            global: RawBuffer {
+                buf: global_buf.as_ptr(),
+                rows: global.rows,
+                cols: global.cols,
+                checked: global.checked,
+            },
+            window: RawBuffer {
+                buf: window.as_mut_ptr(),
+                rows: 2 * window_rows,
+                cols: REGCOUNT_DATA,
+                checked: true,
+            },
+            rows,
+        };
+        let mut state = StreamState {
+            inject,
+            sink,
+            injected: InjectedValues {
+                offsets: vec![],
+                values: vec![],
+            },
+            err: None,
+        };
+        let result = ffi_wrap(|| unsafe {
+            risc0_circuit_rv32im_v2_cpu_witgen_stream(
+                &buffers,
+                preflight.raw,
+                witgen_inject::<I, F>,
+                witgen_sink::<I, F>,
+                &mut state as *mut StreamState<I, F> as *mut c_void,
+            )
+        });
+        match state.err {
+            Some(err) => Err(err),
+            None => result,
+        }
     }
 }
 
@@ -98,8 +338,13 @@ impl CircuitAccumulator<CpuHal> for CpuCircuitHal {
         mix: &MetaBuffer<CpuHal>,
     ) -> Result<()> {
         scope!("accumulate");
-        let cycles = preflight.cycles.len();
-        tracing::debug!("accumulate: {cycles}");
+        // Witgen has normally built the compact copy already.
+        let cached = self.compact.lock().unwrap().take();
+        let preflight = match cached {
+            Some((key, compact)) if key == TraceKey::new(preflight) => compact,
+            _ => CompactPreflight::new(preflight)?,
+        };
+        tracing::debug!("accumulate: {}", preflight.cycles);
         let data_buf = data.buf.as_slice();
         let accum_buf = accum.buf.as_slice();
         let global_buf = global.buf.as_slice();
@@ -130,17 +375,7 @@ impl CircuitAccumulator<CpuHal> for CpuCircuitHal {
                 checked: mix.checked,
             },
         };
-        let preflight = RawPreflightTrace {
-            cycles: preflight.cycles.as_ptr(),
-            txns: preflight.txns.as_ptr(),
-            bigint_bytes: preflight.bigint_bytes.as_ptr(),
-            txns_len: preflight.txns.len() as u32,
-            bigint_bytes_len: preflight.bigint_bytes.len() as u32,
-            table_split_cycle: preflight.table_split_cycle,
-        };
-        ffi_wrap(|| unsafe {
-            risc0_circuit_rv32im_v2_cpu_accum(&buffers, &preflight, cycles as u32)
-        })
+        ffi_wrap(|| unsafe { risc0_circuit_rv32im_v2_cpu_accum(&buffers, preflight.raw) })
     }
 }
 
@@ -156,7 +391,6 @@ impl CircuitHal<CpuHal> for CpuCircuitHal {
     ) {
         scope!("eval_check");
 
-        const EXP_PO2: usize = log2_ceil(INV_RATE);
         let domain = steps * INV_RATE;
         let poly_mix_pows = map_pow(poly_mix, POLY_MIX_POWERS);
 
@@ -180,31 +414,36 @@ impl CircuitHal<CpuHal> for CpuCircuitHal {
 
         let args: &[&[Val]] = &[accum, data, out, mix];
 
-        (0..domain).into_par_iter().for_each(|cycle| {
-            let args: Vec<*const Val> = args.iter().map(|x| (*x).as_ptr()).collect();
-            let mut tot = ExtVal::ZERO;
-            unsafe {
-                risc0_circuit_rv32im_v2_cpu_poly_fp(
-                    cycle,
-                    domain,
-                    poly_mix_pows.as_ptr(),
-                    args.as_ptr(),
-                    &mut tot,
-                )
-            };
-            let x = Val::ROU_FWD[po2 + EXP_PO2].pow(cycle);
-            // TODO: what is this magic number 3?
-            let y = (Val::new(3) * x).pow(1 << po2);
-            let ret = tot * (y - Val::new(1)).inv();
+        let arg_lens: Vec<usize> = args.iter().map(|x| x.len()).collect();
 
-            // SAFETY: This conversion is to make the check slice mutable, which should be
-            // safe because each thread access will not overlap with each other.
-            let check =
-                unsafe { std::slice::from_raw_parts_mut(check.as_ptr() as *mut Val, check.len()) };
-            for i in 0..ExtVal::EXT_SIZE {
-                check[i * domain + cycle] = ret.elems()[i];
-            }
+        // Each call evaluates a whole chunk of the domain, so the FFI call, the argument
+        // pointers and the zerofier inverses are paid for once per chunk.
+        let chunks = domain.div_ceil(EVAL_CHECK_CHUNK);
+        let result = eval_check_pool().install(|| {
+            (0..chunks).into_par_iter().try_for_each(|chunk| {
+                let args: Vec<*const Val> = args.iter().map(|x| (*x).as_ptr()).collect();
+                let begin = chunk * EVAL_CHECK_CHUNK;
+                let end = (begin + EVAL_CHECK_CHUNK).min(domain);
+                // SAFETY: Each chunk writes only its own cycles of the check columns, so the
+                // writes of different threads never overlap.
+                ffi_wrap(|| unsafe {
+                    risc0_circuit_rv32im_v2_cpu_eval_check(
+                        check.as_ptr() as *mut Val,
+                        args.as_ptr(),
+                        arg_lens.as_ptr(),
+                        poly_mix_pows.as_ptr(),
+                        poly_mix_pows.len(),
+                        po2,
+                        domain,
+                        begin,
+                        end,
+                    )
+                })
+            })
         });
+        // CircuitHal::eval_check has no way to return the error, so raise it here, on the calling
+        // thread, once the other chunks have stopped.
+        result.unwrap();
     }
 
     fn accumulate(
@@ -225,6 +464,184 @@ impl CircuitHal<CpuHal> for CpuCircuitHal {
 pub fn segment_prover() -> Result<Box<dyn SegmentProver>> {
     let suite = Poseidon2HashSuite::new_suite();
     let hal = Rc::new(CpuHal::new(suite));
-    let circuit_hal = Rc::new(CpuCircuitHal);
+    let circuit_hal = Rc::new(CpuCircuitHal::default());
     Ok(Box::new(SegmentProverImpl::new(hal, circuit_hal)))
 }
+
+#[cfg(test)]
+mod tests {
+    use risc0_circuit_rv32im_v2_sys::risc0_circuit_rv32im_v2_cpu_poly_fp;
+    use risc0_zkp::{
+        adapter::CircuitInfo as _,
+        core::log2_ceil,
+        field::{ExtElem as _, RootsOfUnity as _},
+    };
+
+    use super::*;
+    use crate::zirgen::{taps::TAPSET, CircuitImpl};
+
+    /// A deterministic stream of field elements (xorshift64*), so that a failure reproduces.
+    struct Rng(u64);
+
+    impl Rng {
+        fn val(&mut self) -> Val {
+            self.0 ^= self.0 >> 12;
+            self.0 ^= self.0 << 25;
+            self.0 ^= self.0 >> 27;
+            Val::from(self.0.wrapping_mul(0x2545_f491_4f6c_dd1d))
+        }
+
+        fn vals(&mut self, count: usize) -> Vec<Val> {
+            (0..count).map(|_| self.val()).collect()
+        }
+    }
+
+    /// Run the native eval_check over each of `ranges` of the domain in turn, and return the check
+    /// columns.
+    #[cfg(target_feature = "avx2")]
+    fn eval_check_ranges(
+        args: &[&[Val]],
+        poly_mix_pows: &[ExtVal],
+        po2: usize,
+        ranges: &[(usize, usize)],
+    ) -> Result<Vec<Val>> {
+        let domain = (1 << po2) * INV_RATE;
+        let mut check = vec![Val::INVALID; 4 * domain];
+        let arg_ptrs: Vec<*const Val> = args.iter().map(|x| x.as_ptr()).collect();
+        let arg_lens: Vec<usize> = args.iter().map(|x| x.len()).collect();
+        eval_check_pool().install(|| {
+            ranges.iter().try_for_each(|&(begin, end)| {
+                ffi_wrap(|| unsafe {
+                    risc0_circuit_rv32im_v2_cpu_eval_check(
+                        check.as_mut_ptr(),
+                        arg_ptrs.as_ptr(),
+                        arg_lens.as_ptr(),
+                        poly_mix_pows.as_ptr(),
+                        poly_mix_pows.len(),
+                        po2,
+                        domain,
+                        begin,
+                        end,
+                    )
+                })
+            })
+        })?;
+        Ok(check)
+    }
+
+    /// The check columns as eval_check computed them before it was native: one call of the
+    /// generated poly_fp per point of the domain, divided by the zerofier computed from scratch.
+    fn eval_check_reference(args: &[&[Val]], poly_mix_pows: &[ExtVal], po2: usize) -> Vec<Val> {
+        const EXP_PO2: usize = log2_ceil(INV_RATE);
+        let domain = (1 << po2) * INV_RATE;
+        let mut check = vec![Val::INVALID; 4 * domain];
+        let arg_ptrs: Vec<*const Val> = args.iter().map(|x| x.as_ptr()).collect();
+        for cycle in 0..domain {
+            let mut tot = ExtVal::ZERO;
+            ffi_wrap(|| unsafe {
+                risc0_circuit_rv32im_v2_cpu_poly_fp(
+                    cycle,
+                    domain,
+                    poly_mix_pows.as_ptr(),
+                    arg_ptrs.as_ptr(),
+                    &mut tot,
+                )
+            })
+            .unwrap();
+            let x = Val::ROU_FWD[po2 + EXP_PO2].pow(cycle);
+            let y = (Val::new(3) * x).pow(1 << po2);
+            let ret = tot * (y - Val::new(1)).inv();
+            for i in 0..ExtVal::EXT_SIZE {
+                check[i * domain + cycle] = ret.elems()[i];
+            }
+        }
+        check
+    }
+
+    /// Random inputs for eval_check over a domain of `(1 << po2) * INV_RATE` points.
+    struct Inputs {
+        accum: Vec<Val>,
+        data: Vec<Val>,
+        out: Vec<Val>,
+        mix: Vec<Val>,
+        poly_mix: ExtVal,
+    }
+
+    impl Inputs {
+        fn new(seed: u64, po2: usize) -> Self {
+            let domain = (1 << po2) * INV_RATE;
+            let mut rng = Rng(seed);
+            Self {
+                accum: rng.vals(TAPSET.group_size(REGISTER_GROUP_ACCUM) * domain),
+                data: rng.vals(TAPSET.group_size(REGISTER_GROUP_DATA) * domain),
+                out: rng.vals(CircuitImpl::OUTPUT_SIZE),
+                mix: rng.vals(CircuitImpl::MIX_SIZE),
+                poly_mix: ExtVal::new(rng.val(), rng.val(), rng.val(), rng.val()),
+            }
+        }
+
+        fn args(&self) -> [&[Val]; 4] {
+            [&self.accum, &self.data, &self.out, &self.mix]
+        }
+    }
+
+    // CpuCircuitHal::eval_check hands out chunks of the domain to the native eval_check, which
+    // evaluates each chunk with the SIMD lanes where they are built and the scalar loop otherwise.
+    // Either way, the result must be identical to the old per-cycle poly_fp. Both sizes of domain
+    // are covered: one shorter than a chunk, and one of several chunks.
+    #[test]
+    fn eval_check_chunked() {
+        for (seed, po2) in [(1, 5), (2, 11)] {
+            let domain = (1 << po2) * INV_RATE;
+            let inputs = Inputs::new(seed, po2);
+            let poly_mix_pows = map_pow(inputs.poly_mix, POLY_MIX_POWERS);
+            let expected = eval_check_reference(&inputs.args(), &poly_mix_pows, po2);
+
+            let mut groups: Vec<_> = (0..3).map(|_| CpuBuffer::from(Vec::new())).collect();
+            groups[REGISTER_GROUP_ACCUM] = CpuBuffer::from(inputs.accum.clone());
+            groups[REGISTER_GROUP_DATA] = CpuBuffer::from(inputs.data.clone());
+            let mut globals: Vec<_> = (0..2).map(|_| CpuBuffer::from(Vec::new())).collect();
+            globals[GLOBAL_MIX] = CpuBuffer::from(inputs.mix.clone());
+            globals[GLOBAL_OUT] = CpuBuffer::from(inputs.out.clone());
+            let check = CpuBuffer::from(vec![Val::INVALID; 4 * domain]);
+            CpuCircuitHal::default().eval_check(
+                &check,
+                &groups.iter().collect::<Vec<_>>(),
+                &globals.iter().collect::<Vec<_>>(),
+                inputs.poly_mix,
+                po2,
+                1 << po2,
+            );
+            assert!(
+                *check.as_slice() == *expected,
+                "chunked and per-cycle eval_check differ for po2 {po2}"
+            );
+        }
+    }
+
+    // The SIMD lanes of eval_check only evaluate whole groups of consecutive cycles, and anything
+    // shorter than a group is left to the scalar poly_fp. So evaluating the domain in a few long
+    // ranges, and again one cycle at a time, compares the lanes against the scalar code bit for
+    // bit. The long ranges start off a group boundary, so the scalar remainder is covered too. The
+    // lanes are only built with AVX2, see poly_fp_lanes.h.
+    #[cfg(target_feature = "avx2")]
+    #[test]
+    fn eval_check_lanes() {
+        const PO2: usize = 6;
+        let domain = (1 << PO2) * INV_RATE;
+        for seed in 1..=4 {
+            let inputs = Inputs::new(seed, PO2);
+            let poly_mix_pows = map_pow(inputs.poly_mix, POLY_MIX_POWERS);
+            let args = inputs.args();
+
+            let lanes =
+                eval_check_ranges(&args, &poly_mix_pows, PO2, &[(0, 3), (3, domain)]).unwrap();
+            let scalar: Vec<(usize, usize)> = (0..domain).map(|cycle| (cycle, cycle + 1)).collect();
+            let scalar = eval_check_ranges(&args, &poly_mix_pows, PO2, &scalar).unwrap();
+            assert!(
+                lanes == scalar,
+                "lanes and scalar eval_check differ for seed {seed}"
+            );
+        }
+    }
+}
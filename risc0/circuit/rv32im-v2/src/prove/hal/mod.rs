@@ -55,7 +55,7 @@ where
     H: Hal<Field = CircuitField, Elem = Val, ExtElem = ExtVal>,
 {
     pub fn new(name: &'static str, hal: &H, rows: usize, cols: usize, checked: bool) -> Self {
-        let buf = hal.alloc_elem_init(name, rows * cols, Val::INVALID);
+        let buf = hal.alloc_elem_rows(name, rows, cols, Val::INVALID);
         Self {
             buf,
             rows,
@@ -71,11 +71,29 @@ where
 }
 
 #[allow(dead_code)]
-#[derive(Clone, Copy, PartialEq)]
+#[derive(Clone, Copy, Debug, PartialEq)]
 pub(crate) enum StepMode {
     Parallel,
     SeqForward,
     SeqReverse,
+    /// Like [StepMode::Parallel], but each worker runs a block of consecutive cycles against a
+    /// row-major staging tile, which is then transposed into the data buffer.
+    ParallelTiled,
+    /// Like [StepMode::Parallel], but cycles are grouped by instruction (preflight major/minor) so
+    /// each worker mostly runs a single instruction's code path.
+    ParallelBucketed,
+}
+
+impl StepMode {
+    /// The parallel mode to use, which can be selected by setting RISC0_WITGEN_MODE to `tiled` or
+    /// `bucketed`.
+    fn parallel() -> Self {
+        match std::env::var("RISC0_WITGEN_MODE").as_deref() {
+            Ok("tiled") => StepMode::ParallelTiled,
+            Ok("bucketed") => StepMode::ParallelBucketed,
+            _ => StepMode::Parallel,
+        }
+    }
 }
 
 pub(crate) trait CircuitWitnessGenerator<H: Hal> {
@@ -132,12 +150,12 @@ where
                 let mode = if std::env::var_os("RISC0_WITGEN_DEBUG").is_some() {
                     StepMode::SeqForward
                 } else {
-                    StepMode::Parallel
+                    StepMode::parallel()
                 };
             } else {
                 let mut rng = rand::thread_rng();
                 let rand_z = ExtVal::random(&mut rng);
-                let mode = StepMode::Parallel;
+                let mode = StepMode::parallel();
             }
         }
 
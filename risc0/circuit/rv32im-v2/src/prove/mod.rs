@@ -19,7 +19,10 @@ mod witgen;
 
 use anyhow::Result;
 use cfg_if::cfg_if;
+use risc0_core::field::baby_bear::BabyBearExtElem;
+use risc0_zkp::{core::hash::poseidon2::Poseidon2HashSuite, hal::cpu::CpuHal};
 
+pub use self::hal::cpu::WitnessBlock;
 use crate::execute::segment::Segment;
 
 const GLOBAL_MIX: usize = 0;
@@ -42,3 +45,23 @@ pub fn segment_prover() -> Result<Box<dyn SegmentProver>> {
         }
     }
 }
+
+/// Generate the witness of `segment` on the CPU without holding all of it in memory. The data
+/// columns are generated a window of `1 << window_po2` rows at a time, and each finished window is
+/// handed to `sink` in row order. `rand_z` is the randomness the prover mixes into the segment's
+/// global values.
+///
+/// Proving needs the whole data buffer at once, so this is for consumers which read the witness in
+/// a single pass, such as exporting it. An error from `sink` stops witgen and is returned.
+pub fn stream_witness<F>(
+    segment: &Segment,
+    rand_z: BabyBearExtElem,
+    window_po2: usize,
+    sink: F,
+) -> Result<()>
+where
+    F: FnMut(&WitnessBlock) -> Result<()>,
+{
+    let hal = CpuHal::new(Poseidon2HashSuite::new_suite());
+    witgen::stream_witness(&hal, segment, rand_z, window_po2, sink)
+}
@@ -20,7 +20,7 @@ pub(crate) mod sha2;
 #[cfg(test)]
 mod tests;
 
-use std::iter::zip;
+use std::{iter::zip, ops::Range};
 
 use anyhow::{Context, Result};
 use preflight::PreflightTrace;
@@ -30,11 +30,14 @@ use risc0_core::scope;
 use risc0_zkp::{
     core::digest::DIGEST_WORDS,
     field::{Elem as _, ExtElem as _},
-    hal::Hal,
+    hal::{cpu::CpuHal, Hal},
 };
 
 use self::preflight::Back;
-use super::hal::{CircuitAccumulator, CircuitWitnessGenerator, MetaBuffer, StepMode};
+use super::hal::{
+    cpu::{CompactPreflight, CpuCircuitHal, InjectedValues, WitnessBlock},
+    CircuitAccumulator, CircuitWitnessGenerator, MetaBuffer, StepMode,
+};
 use crate::{
     execute::{
         bigint::BigIntState,
@@ -89,40 +92,7 @@ where
         assert!(cycles <= 1 << segment.po2, "cycles <= 1 << segment.po2");
         let cycles = 1 << segment.po2;
 
-        let mut global = vec![Val::INVALID; REGCOUNT_GLOBAL];
-
-        // state in
-        for (i, word) in segment.claim.pre_state.as_words().iter().enumerate() {
-            let low = word & 0xffff;
-            let high = word >> 16;
-            global[LAYOUT_GLOBAL.state_in.values[i].low._super.offset] = low.into();
-            global[LAYOUT_GLOBAL.state_in.values[i].high._super.offset] = high.into();
-        }
-
-        // input digest
-        for (i, word) in segment.claim.input.as_words().iter().enumerate() {
-            let low = word & 0xffff;
-            let high = word >> 16;
-            global[LAYOUT_GLOBAL.input.values[i].low._super.offset] = low.into();
-            global[LAYOUT_GLOBAL.input.values[i].high._super.offset] = high.into();
-        }
-
-        // rand_z
-        for (i, &elem) in trace.rand_z.elems().iter().enumerate() {
-            global[LAYOUT_GLOBAL.rng._super.offset + i] = elem;
-        }
-
-        // is_terminate
-        let is_terminate = if segment.claim.terminate_state.is_some() {
-            1u32
-        } else {
-            0u32
-        };
-        global[LAYOUT_GLOBAL.is_terminate._super.offset] = is_terminate.into();
-
-        // shutdown_cycle
-        global[LAYOUT_GLOBAL.shutdown_cycle._super.offset] = segment.segment_threshold.into();
-
+        let global = global_values(segment, &trace);
         let global = MetaBuffer {
             buf: hal.copy_from_elem("global", &global),
             rows: 1,
@@ -137,46 +107,7 @@ where
             MetaBuffer::new("data", hal, cycles, REGCOUNT_DATA, true)
         );
 
-        // Set stateful columns from 'top'
-        let mut injector = Injector::new(cycles);
-        for (row, back) in trace.backs.iter().enumerate() {
-            let cycle = &trace.cycles[row];
-            // tracing::trace!(
-            //     "[{row}] pc: {:#010x}, state: {:?}",
-            //     cycle.pc,
-            //     crate::execute::CycleState::from_u32(cycle.state).unwrap()
-            // );
-            match back {
-                Back::None => {}
-                Back::Ecall(s0, s1, s2) => {
-                    const ECALL_S0: usize = LAYOUT_TOP.inst_result.arm8.s0._super.offset;
-                    const ECALL_S1: usize = LAYOUT_TOP.inst_result.arm8.s1._super.offset;
-                    const ECALL_S2: usize = LAYOUT_TOP.inst_result.arm8.s2._super.offset;
-                    injector.set(row, ECALL_S0, *s0);
-                    injector.set(row, ECALL_S1, *s1);
-                    injector.set(row, ECALL_S2, *s2);
-                }
-                Back::Poseidon2(p2_state) => {
-                    for (col, value) in zip(Poseidon2State::offsets(), p2_state.as_array()) {
-                        injector.set(row, col, value);
-                    }
-                }
-                Back::Sha2(sha2_state) => {
-                    for (col, value) in zip(Sha2State::fp_offsets(), sha2_state.fp_array()) {
-                        injector.set(row, col, value);
-                    }
-                    for (col, value) in zip(Sha2State::u32_offsets(), sha2_state.u32_array()) {
-                        injector.set_u32_bits(row, col, value);
-                    }
-                }
-                Back::BigInt(state) => {
-                    for (col, value) in zip(BigIntState::offsets(), state.as_array()) {
-                        injector.set(row, col, value);
-                    }
-                }
-            }
-            injector.set_cycle(row, cycle);
-        }
+        let injector = inject_backs(&trace, cycles);
 
         hal.scatter(
             &data.buf,
@@ -259,6 +190,7 @@ where
                 injector.push();
             }
         }
+        injector.encode();
 
         hal.scatter(
             &self.accum.buf,
@@ -284,17 +216,164 @@ where
     }
 }
 
+/// Streaming alternative to [WitnessGenerator::new] on the CPU, see [crate::prove::stream_witness].
+/// The data buffer is generated a window of `1 << window_po2` rows at a time, and each finished
+/// window is handed to `sink` in order rather than kept in memory. The values injected into each
+/// window are also only computed as it is reached.
+pub(crate) fn stream_witness<F>(
+    hal: &CpuHal<CircuitField>,
+    segment: &Segment,
+    rand_z: ExtVal,
+    window_po2: usize,
+    sink: F,
+) -> Result<()>
+where
+    F: FnMut(&WitnessBlock) -> Result<()>,
+{
+    scope!("witgen_stream");
+
+    let mut trace = segment.preflight(rand_z)?;
+    assert!(
+        trace.cycles.len() <= 1 << segment.po2,
+        "cycles <= 1 << segment.po2"
+    );
+    let cycles = 1 << segment.po2;
+    let window_rows = 1 << window_po2.min(segment.po2 - 1);
+
+    let global = global_values(segment, &trace);
+    let global = MetaBuffer {
+        buf: hal.copy_from_elem("global", &global),
+        rows: 1,
+        cols: REGCOUNT_GLOBAL,
+        checked: true,
+    };
+
+    // The compact copy replaces the transactions and bigint bytes. The cycles and backs are still
+    // needed to compute each window's injected values.
+    let preflight = CompactPreflight::new(&trace)?;
+    trace.txns = Vec::new();
+    trace.bigint_bytes = Vec::new();
+
+    CpuCircuitHal::default()
+        .stream_witness(
+            &preflight,
+            &global,
+            cycles,
+            window_rows,
+            |begin, end| Ok(inject_rows(&trace, cycles, begin..end).into_values()),
+            sink,
+        )
+        .context("witness generation failure")
+}
+
+fn global_values(segment: &Segment, trace: &PreflightTrace) -> Vec<Val> {
+    let mut global = vec![Val::INVALID; REGCOUNT_GLOBAL];
+
+    // state in
+    for (i, word) in segment.claim.pre_state.as_words().iter().enumerate() {
+        let low = word & 0xffff;
+        let high = word >> 16;
+        global[LAYOUT_GLOBAL.state_in.values[i].low._super.offset] = low.into();
+        global[LAYOUT_GLOBAL.state_in.values[i].high._super.offset] = high.into();
+    }
+
+    // input digest
+    for (i, word) in segment.claim.input.as_words().iter().enumerate() {
+        let low = word & 0xffff;
+        let high = word >> 16;
+        global[LAYOUT_GLOBAL.input.values[i].low._super.offset] = low.into();
+        global[LAYOUT_GLOBAL.input.values[i].high._super.offset] = high.into();
+    }
+
+    // rand_z
+    for (i, &elem) in trace.rand_z.elems().iter().enumerate() {
+        global[LAYOUT_GLOBAL.rng._super.offset + i] = elem;
+    }
+
+    // is_terminate
+    let is_terminate = if segment.claim.terminate_state.is_some() {
+        1u32
+    } else {
+        0u32
+    };
+    global[LAYOUT_GLOBAL.is_terminate._super.offset] = is_terminate.into();
+
+    // shutdown_cycle
+    global[LAYOUT_GLOBAL.shutdown_cycle._super.offset] = segment.segment_threshold.into();
+
+    global
+}
+
+fn inject_backs(trace: &PreflightTrace, cycles: usize) -> Injector {
+    inject_rows(trace, cycles, 0..trace.backs.len())
+}
+
+/// The values to inject into `rows` of the data buffer, which has `cycles` rows.
+fn inject_rows(trace: &PreflightTrace, cycles: usize, rows: Range<usize>) -> Injector {
+    let rows = rows.start..rows.end.min(trace.backs.len());
+    // Set stateful columns from 'top'
+    let mut injector = Injector::with_capacity(cycles, rows.len());
+    for row in rows {
+        let back = &trace.backs[row];
+        let cycle = &trace.cycles[row];
+        // tracing::trace!(
+        //     "[{row}] pc: {:#010x}, state: {:?}",
+        //     cycle.pc,
+        //     crate::execute::CycleState::from_u32(cycle.state).unwrap()
+        // );
+        match back {
+            Back::None => {}
+            Back::Ecall(s0, s1, s2) => {
+                const ECALL_S0: usize = LAYOUT_TOP.inst_result.arm8.s0._super.offset;
+                const ECALL_S1: usize = LAYOUT_TOP.inst_result.arm8.s1._super.offset;
+                const ECALL_S2: usize = LAYOUT_TOP.inst_result.arm8.s2._super.offset;
+                injector.set(row, ECALL_S0, *s0);
+                injector.set(row, ECALL_S1, *s1);
+                injector.set(row, ECALL_S2, *s2);
+            }
+            Back::Poseidon2(p2_state) => {
+                for (col, value) in zip(Poseidon2State::offsets(), p2_state.as_array()) {
+                    injector.set(row, col, value);
+                }
+            }
+            Back::Sha2(sha2_state) => {
+                for (col, value) in zip(Sha2State::fp_offsets(), sha2_state.fp_array()) {
+                    injector.set(row, col, value);
+                }
+                for (col, value) in zip(Sha2State::u32_offsets(), sha2_state.u32_array()) {
+                    injector.set_u32_bits(row, col, value);
+                }
+            }
+            Back::BigInt(state) => {
+                for (col, value) in zip(BigIntState::offsets(), state.as_array()) {
+                    injector.set(row, col, value);
+                }
+            }
+        }
+        injector.set_cycle(row, cycle);
+    }
+    injector.encode();
+
+    injector
+}
+
 #[derive(Debug)]
 struct Injector {
     rows: usize,
     offsets: Vec<u32>,
+    /// The values as plain integers until [Injector::encode] converts them to Montgomery form.
     values: Vec<Val>,
     index: Vec<u32>,
 }
 
 impl Injector {
     fn new(rows: usize) -> Self {
-        let mut index = Vec::with_capacity(rows + 1);
+        Self::with_capacity(rows, rows)
+    }
+
+    /// An empty injector for a buffer of `rows` rows, with room for `count` of them.
+    fn with_capacity(rows: usize, count: usize) -> Self {
+        let mut index = Vec::with_capacity(count + 1);
         index.push(0);
         Self {
             rows,
@@ -308,6 +387,13 @@ impl Injector {
         self.index.push(self.offsets.len() as u32);
     }
 
+    fn into_values(self) -> InjectedValues {
+        InjectedValues {
+            offsets: self.offsets,
+            values: self.values,
+        }
+    }
+
     fn set_cycle(&mut self, row: usize, cycle: &RawPreflightCycle) {
         const CYCLE_COL: usize = LAYOUT_TOP.cycle._super.offset;
         const NEXT_PC_LOW: usize = LAYOUT_TOP.next_pc_low._super.offset;
@@ -325,7 +411,19 @@ impl Injector {
     fn set(&mut self, row: usize, col: usize, value: u32) {
         let idx = col * self.rows + row;
         self.offsets.push(idx as u32);
-        self.values.push(value.into());
+        self.values.push(Val::new_raw(value));
+    }
+
+    /// Convert all the values set so far from plain integers to Montgomery form, like `Val::from`,
+    /// in a single vectorized pass rather than a field multiply per [Injector::set].
+    fn encode(&mut self) {
+        // SAFETY: Val is a repr(transparent) u32, and the call only touches the `len` values.
+        unsafe {
+            risc0_sys::risc0_fp_encode_bulk_inplace(
+                self.values.as_mut_ptr() as *mut u32,
+                self.values.len(),
+            )
+        };
     }
 
     fn set_u32_bits(&mut self, row: usize, col: usize, value: u32) {
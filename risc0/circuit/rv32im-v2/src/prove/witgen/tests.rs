@@ -12,7 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-use std::rc::Rc;
+use std::{rc::Rc, time::Instant};
 
 use rand::thread_rng;
 use risc0_binfmt::{MemoryImage2, Program};
@@ -24,7 +24,7 @@ use crate::{
         testutil::{self, NullSyscall, DEFAULT_SESSION_LIMIT},
         DEFAULT_SEGMENT_LIMIT_PO2,
     },
-    prove::{hal::StepMode, witgen::WitnessGenerator},
+    prove::{hal::StepMode, stream_witness, witgen::WitnessGenerator},
     zirgen::circuit::{ExtVal, REGCOUNT_DATA},
     MAX_INSN_CYCLES,
 };
@@ -60,6 +60,10 @@ fn simple_loop() {
 }
 
 fn fwd_rev_ab_test(program: Program) {
+    step_mode_ab_test(program, StepMode::SeqForward, StepMode::SeqReverse);
+}
+
+fn step_mode_ab_test(program: Program, mode_a: StepMode, mode_b: StepMode) {
     let image = MemoryImage2::new_kernel(program);
 
     let session = testutil::execute(
@@ -86,7 +90,7 @@ fn fwd_rev_ab_test(program: Program) {
         } else {
             let suite = risc0_zkp::core::hash::poseidon2::Poseidon2HashSuite::new_suite();
             let hal = Rc::new(risc0_zkp::hal::cpu::CpuHal::new(suite));
-            let circuit_hal = crate::prove::hal::cpu::CpuCircuitHal;
+            let circuit_hal = crate::prove::hal::cpu::CpuCircuitHal::default();
         }
     }
 
@@ -95,31 +99,19 @@ fn fwd_rev_ab_test(program: Program) {
 
     let segments = session.segments;
     for segment in segments {
-        tracing::debug!("fwd");
-        let fwd_witgen = WitnessGenerator::new(
-            hal.as_ref(),
-            &circuit_hal,
-            &segment,
-            StepMode::SeqForward,
-            rand_z,
-        )
-        .unwrap();
-        tracing::debug!("rev");
-        let rev_witgen = WitnessGenerator::new(
-            hal.as_ref(),
-            &circuit_hal,
-            &segment,
-            StepMode::SeqReverse,
-            rand_z,
-        )
-        .unwrap();
+        tracing::debug!("a");
+        let a_witgen =
+            WitnessGenerator::new(hal.as_ref(), &circuit_hal, &segment, mode_a, rand_z).unwrap();
+        tracing::debug!("b");
+        let b_witgen =
+            WitnessGenerator::new(hal.as_ref(), &circuit_hal, &segment, mode_b, rand_z).unwrap();
         let cycles = 1 << segment.po2;
-        let fwd_vec = fwd_witgen.data.to_vec();
-        let rev_vec = rev_witgen.data.to_vec();
+        let a_vec = a_witgen.data.to_vec();
+        let b_vec = b_witgen.data.to_vec();
         for row in 0..cycles {
-            let fwd_row = &fwd_vec[row * REGCOUNT_DATA..row * REGCOUNT_DATA + REGCOUNT_DATA];
-            let rev_row = &rev_vec[row * REGCOUNT_DATA..row * REGCOUNT_DATA + REGCOUNT_DATA];
-            assert_eq!(fwd_row, rev_row, "cycle: {row}");
+            let a_row = &a_vec[row * REGCOUNT_DATA..row * REGCOUNT_DATA + REGCOUNT_DATA];
+            let b_row = &b_vec[row * REGCOUNT_DATA..row * REGCOUNT_DATA + REGCOUNT_DATA];
+            assert_eq!(a_row, b_row, "cycle: {row}");
         }
     }
 }
@@ -133,3 +125,126 @@ fn fwd_rev_ab_basic() {
 fn fwd_rev_ab_split() {
     fwd_rev_ab_test(testutil::kernel::simple_loop(2000));
 }
+
+#[test]
+fn fwd_tiled_ab_basic() {
+    step_mode_ab_test(
+        testutil::kernel::basic(),
+        StepMode::SeqForward,
+        StepMode::ParallelTiled,
+    );
+}
+
+#[test]
+fn fwd_tiled_ab_split() {
+    step_mode_ab_test(
+        testutil::kernel::simple_loop(2000),
+        StepMode::SeqForward,
+        StepMode::ParallelTiled,
+    );
+}
+
+#[test]
+fn fwd_bucketed_ab_split() {
+    step_mode_ab_test(
+        testutil::kernel::simple_loop(2000),
+        StepMode::SeqForward,
+        StepMode::ParallelBucketed,
+    );
+}
+
+#[test]
+fn fwd_parallel_ab_split() {
+    step_mode_ab_test(
+        testutil::kernel::simple_loop(2000),
+        StepMode::SeqForward,
+        StepMode::Parallel,
+    );
+}
+
+/// Compares witness generation time for each of the parallel step modes. To also see the effect on
+/// the i-cache and branch predictors, run it under perf:
+///
+/// ```text
+/// perf stat -e L1-icache-load-misses,branch-misses cargo test --release \
+///     -p risc0-circuit-rv32im-v2 step_mode_bench -- --ignored --nocapture
+/// ```
+#[test]
+#[ignore]
+fn step_mode_bench() {
+    let image = MemoryImage2::new_kernel(testutil::kernel::simple_loop(100_000));
+    let session = testutil::execute(
+        image,
+        DEFAULT_SEGMENT_LIMIT_PO2,
+        MAX_INSN_CYCLES,
+        DEFAULT_SESSION_LIMIT,
+        &NullSyscall,
+        None,
+    )
+    .unwrap();
+
+    let suite = risc0_zkp::core::hash::poseidon2::Poseidon2HashSuite::new_suite();
+    let hal = risc0_zkp::hal::cpu::CpuHal::new(suite);
+    let circuit_hal = crate::prove::hal::cpu::CpuCircuitHal::default();
+    let rand_z = ExtVal::random(&mut thread_rng());
+
+    for segment in session.segments {
+        for mode in [
+            StepMode::Parallel,
+            StepMode::ParallelTiled,
+            StepMode::ParallelBucketed,
+        ] {
+            let start = Instant::now();
+            WitnessGenerator::new(&hal, &circuit_hal, &segment, mode, rand_z).unwrap();
+            println!(
+                "po2: {}, mode: {mode:?}, witgen: {:.3}s",
+                segment.po2,
+                start.elapsed().as_secs_f64()
+            );
+        }
+    }
+}
+
+#[test]
+fn stream_ab_split() {
+    let image = MemoryImage2::new_kernel(testutil::kernel::simple_loop(2000));
+    let session = testutil::execute(
+        image,
+        DEFAULT_SEGMENT_LIMIT_PO2,
+        MAX_INSN_CYCLES,
+        DEFAULT_SESSION_LIMIT,
+        &NullSyscall,
+        None,
+    )
+    .unwrap();
+
+    let suite = risc0_zkp::core::hash::poseidon2::Poseidon2HashSuite::new_suite();
+    let hal = risc0_zkp::hal::cpu::CpuHal::new(suite);
+    let circuit_hal = crate::prove::hal::cpu::CpuCircuitHal::default();
+    let rand_z = ExtVal::random(&mut thread_rng());
+
+    for segment in session.segments {
+        let witgen =
+            WitnessGenerator::new(&hal, &circuit_hal, &segment, StepMode::SeqForward, rand_z)
+                .unwrap();
+        let cycles = 1 << segment.po2;
+        let expected = witgen.data.to_vec();
+        let mut next_row = 0;
+        stream_witness(&segment, rand_z, 10, |block| {
+            assert_eq!(block.first_row, next_row);
+            for col in 0..REGCOUNT_DATA {
+                let start = col * cycles + block.first_row;
+                assert_eq!(
+                    block.column(col),
+                    &expected[start..start + block.rows],
+                    "col: {col}, row: {}",
+                    block.first_row
+                );
+            }
+            next_row += block.rows;
+            Ok(())
+        })
+        .unwrap();
+        assert_eq!(next_row, cycles);
+    }
+}
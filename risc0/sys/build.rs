@@ -24,6 +24,8 @@ fn main() {
     let cxx_root = manifest_dir.join("cxx");
     println!("cargo:cxx_root={}", cxx_root.to_string_lossy());
 
+    build_cpu_kernels(&cxx_root);
+
     if env::var("CARGO_FEATURE_CUDA").is_ok() {
         println!(
             "cargo:cuda_root={}",
@@ -41,6 +43,35 @@ fn main() {
     }
 }
 
+fn build_cpu_kernels(cxx_root: &Path) {
+    KernelBuild::new(KernelType::Cpp)
+        .files(["kernels/zkp/cxx/ffi.cpp"])
+        .deps(["cxx", "kernels/zkp/cxx"])
+        .include(cxx_root)
+        .compile("risc0_zkp_cpu");
+
+    // The tests of the C++ primitives go in a library of their own, which only the extern block of
+    // src/tests.rs links, so they stay out of risc0_zkp_cpu.
+    KernelBuild::new(KernelType::Cpp)
+        .files([
+            "kernels/zkp/cxx/tests/fpvec.cpp",
+            "kernels/zkp/cxx/tests/fpaccum.cpp",
+            "kernels/zkp/cxx/tests/batch_inv.cpp",
+            "kernels/zkp/cxx/tests/fplazy.cpp",
+            "kernels/zkp/cxx/tests/fp_bulk.cpp",
+            "kernels/zkp/cxx/tests/fpext.cpp",
+            "kernels/zkp/cxx/tests/fpextvec.cpp",
+            "kernels/zkp/cxx/tests/rou.cpp",
+            "kernels/zkp/cxx/tests/parallel_for.cpp",
+            "kernels/zkp/cxx/tests/numa.cpp",
+            "kernels/zkp/cxx/tests/prefix_sum.cpp",
+        ])
+        .deps(["cxx", "kernels/zkp/cxx/tests"])
+        .include(cxx_root)
+        .no_link()
+        .compile("risc0_zkp_cpu_tests");
+}
+
 fn build_cuda_kernels(cxx_root: &Path) {
     KernelBuild::new(KernelType::Cuda)
         .files([
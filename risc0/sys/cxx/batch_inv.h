@@ -0,0 +1,118 @@
+// Copyright 2025 RISC Zero, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/// \file
+/// Batch inversion of Fp and FpExt arrays using Montgomery's trick.
+
+#include "fp.h"
+#include "fpext.h"
+
+#if defined(__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wmissing-braces"
+#elif defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-braces"
+#endif
+
+#include "vendor/poolstl.hpp"
+
+#if defined(__clang__)
+#pragma clang diagnostic pop
+#elif defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace risc0 {
+
+namespace detail {
+
+// Montgomery's trick: with prefix[i] = elems[0] * ... * elems[i - 1], a single inversion of the
+// full product lets us peel off each inverse from the back as
+//   1/elems[i] = prefix[i] * 1/(elems[0] * ... * elems[i])
+//   1/(elems[0] * ... * elems[i - 1]) = elems[i] * 1/(elems[0] * ... * elems[i])
+// which is 3 multiplies per element.  Zeros are skipped in the running product and left in place,
+// so the 'inverse of zero is zero' behavior of inv() is preserved without poisoning the rest of the
+// batch.
+template <typename T> inline void batchInvImpl(T* elems, size_t count, T* prefix) {
+  T acc(1);
+  for (size_t i = 0; i < count; i++) {
+    prefix[i] = acc;
+    if (elems[i] != T()) {
+      acc *= elems[i];
+    }
+  }
+  T accInv = inv(acc);
+  for (size_t i = count; i-- > 0;) {
+    T x = elems[i];
+    if (x != T()) {
+      elems[i] = accInv * prefix[i];
+      accInv *= x;
+    }
+  }
+}
+
+template <typename T> inline void batchInvPar(T* elems, size_t count, size_t chunkSize) {
+  if (chunkSize == 0) {
+    chunkSize = 1;
+  }
+  size_t chunks = (count + chunkSize - 1) / chunkSize;
+  std::vector<T> prefix(count);
+  auto begin = poolstl::iota_iter<size_t>(0);
+  auto end = poolstl::iota_iter<size_t>(chunks);
+  std::for_each(poolstl::par, begin, end, [&](size_t chunk) {
+    size_t offset = chunk * chunkSize;
+    size_t len = std::min(chunkSize, count - offset);
+    batchInvImpl(elems + offset, len, prefix.data() + offset);
+  });
+}
+
+} // namespace detail
+
+/// The default number of elements each task of batchInvParallel inverts with a single inversion.
+constexpr size_t kBatchInvChunkSize = 4096;
+
+/// Replace each element of elems with its multiplicative inverse, see inv(Fp).  This costs a single
+/// inversion plus 3 multiplies per element.  Zero elements remain zero.
+inline void batchInv(Fp* elems, size_t count) {
+  std::vector<Fp> prefix(count);
+  detail::batchInvImpl(elems, count, prefix.data());
+}
+
+/// Replace each element of elems with its multiplicative inverse, see inv(FpExt).  This costs a
+/// single inversion plus 3 multiplies per element.  Zero elements remain zero.
+inline void batchInv(FpExt* elems, size_t count) {
+  std::vector<FpExt> prefix(count);
+  detail::batchInvImpl(elems, count, prefix.data());
+}
+
+/// A parallel version of batchInv which splits elems into chunks of chunkSize elements and inverts
+/// each chunk on the thread pool, costing one inversion per chunk.
+inline void batchInvParallel(Fp* elems, size_t count, size_t chunkSize = kBatchInvChunkSize) {
+  detail::batchInvPar(elems, count, chunkSize);
+}
+
+/// A parallel version of batchInv which splits elems into chunks of chunkSize elements and inverts
+/// each chunk on the thread pool, costing one inversion per chunk.
+inline void batchInvParallel(FpExt* elems, size_t count, size_t chunkSize = kBatchInvChunkSize) {
+  detail::batchInvPar(elems, count, chunkSize);
+}
+
+} // namespace risc0
@@ -66,9 +66,8 @@ private:
     return (r > P ? r + P : r);
   }
 
-  // Multiply two numbers
-  static constexpr inline uint32_t mul(uint32_t a, uint32_t b) {
-    uint64_t o64 = uint64_t(a) * uint64_t(b);
+  // Montgomery reduce a 64 bit value, which must be < P * 2^32
+  static constexpr inline uint32_t reduce(uint64_t o64) {
     uint32_t low = -uint32_t(o64);
     uint32_t red = M * low;
     o64 += uint64_t(red) * uint64_t(P);
@@ -76,6 +75,11 @@ private:
     return (ret >= P ? ret - P : ret);
   }
 
+  // Multiply two numbers
+  static constexpr inline uint32_t mul(uint32_t a, uint32_t b) {
+    return reduce(uint64_t(a) * uint64_t(b));
+  }
+
   // Encode / Decode
   static constexpr inline uint32_t encode(uint32_t a) { return mul(R2, a); }
   static constexpr inline uint32_t decode(uint32_t a) { return mul(1, a); }
@@ -96,6 +100,14 @@ public:
   /// Return the underlying value
   constexpr inline uint32_t asRaw() const { return val; }
 
+  /// Construct an Fp directly from its internal form, the inverse of asRaw().
+  static constexpr inline Fp fromRaw(uint32_t val) { return Fp(val, true); }
+
+  /// Construct an Fp from the Montgomery reduction of x, where x must be < P * 2^32.  In
+  /// particular, for Fp values a and b, fromReduced(a.asRaw() * b.asRaw()) == a * b, which allows
+  /// sums of raw products to be reduced once rather than per term (see FpAccum).
+  static constexpr inline Fp fromReduced(uint64_t x) { return Fp(reduce(x), true); }
+
   /// Get the largest value, basically P - 1.
   static constexpr inline Fp maxVal() { return P - 1; }
 
@@ -183,13 +195,30 @@ constexpr inline Fp pow(Fp x, size_t n) {
   return tot;
 }
 
+/// Raise a value to the fixed power P-2 using an addition chain.  In binary, P-2 is 1110 followed by
+/// 27 ones, so we build x^0b111 and then repeatedly shift in 3 more ones, which takes 30 squarings
+/// and 11 multiplies (the generic pow takes 31 squarings and 30 multiplies).  This is templated so
+/// that packed types such as FpVec can share it.
+template <typename T> constexpr inline T powPMinus2(T x) {
+  T x3 = x * x * x;
+  T x7 = x3 * x3 * x;
+  T ret = x7 * x7;
+  for (size_t i = 0; i < 9; i++) {
+    ret = ret * ret;
+    ret = ret * ret;
+    ret = ret * ret;
+    ret = ret * x7;
+  }
+  return ret;
+}
+
 /// Compute the multiplicative inverse of x, or `1/x` in finite field terms.  Since `x^(P-1) == 1
 /// (mod P)` for any x != 0 (as a consequence of Fermat's little theorem), it follows that `x *
 /// x^(P-2) == 1 (mod P)` for x != 0.  That is, `x^(P-2)` is the multiplicative inverse of x.
 /// Computed this way, the 'inverse' of zero comes out as zero, which is convenient in many cases,
 /// so we leave it.
 constexpr inline Fp inv(Fp x) {
-  return pow(x, Fp::P - 2);
+  return powPMinus2(x);
 }
 
 } // namespace risc0
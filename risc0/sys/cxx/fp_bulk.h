@@ -0,0 +1,108 @@
+// Copyright 2025 RISC Zero, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/// \file
+/// Bulk conversion between plain uint32_t values and Fp (Montgomery form).
+
+#include "fp.h"
+#include "fpvec.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace risc0 {
+
+namespace detail {
+
+// Encoding is a Montgomery multiply by R2 = 2^64 mod P, and decoding is a Montgomery multiply by 1.
+// Both are valid for any 32-bit input: a * b < 2^32 * P, which is all the reduction requires, so
+// encode also wraps values >= P just like Fp(uint32_t) does.
+constexpr Fp kEncodeFactor = Fp::fromRaw(Fp::R2);
+constexpr Fp kDecodeFactor = Fp::fromRaw(1);
+
+// Multiply every element by the raw factor.  out may equal in, since each block is fully loaded
+// before it is stored.
+inline void bulkMulRaw(uint32_t* out, const uint32_t* in, size_t count, Fp factor) {
+  using Vec = FpVecNative;
+  const Fp* src = reinterpret_cast<const Fp*>(in);
+  Fp* dst = reinterpret_cast<Fp*>(out);
+  Vec vfactor(factor);
+  size_t i = 0;
+  for (; i + Vec::LANES <= count; i += Vec::LANES) {
+    (Vec::load(src + i) * vfactor).store(dst + i);
+  }
+  for (; i < count; i++) {
+    dst[i] = src[i] * factor;
+  }
+}
+
+// Strided version of bulkMulRaw.  Lanes are gathered into a block so the multiply is still done a
+// full vector at a time.
+inline void bulkMulRawStrided(
+    uint32_t* out, size_t outStride, const uint32_t* in, size_t inStride, size_t count, Fp factor) {
+  using Vec = FpVecNative;
+  const Fp* src = reinterpret_cast<const Fp*>(in);
+  Fp* dst = reinterpret_cast<Fp*>(out);
+  Vec vfactor(factor);
+  Fp block[Vec::LANES];
+  size_t i = 0;
+  for (; i + Vec::LANES <= count; i += Vec::LANES) {
+    for (size_t j = 0; j < Vec::LANES; j++) {
+      block[j] = src[(i + j) * inStride];
+    }
+    (Vec::load(block) * vfactor).store(block);
+    for (size_t j = 0; j < Vec::LANES; j++) {
+      dst[(i + j) * outStride] = block[j];
+    }
+  }
+  for (; i < count; i++) {
+    dst[i * outStride] = src[i * inStride] * factor;
+  }
+}
+
+} // namespace detail
+
+/// Convert count plain values to Fp, i.e. out[i] = Fp(in[i]).  Values >= P are wrapped.  out may be
+/// the same array as in.
+inline void encodeBulk(Fp* out, const uint32_t* in, size_t count) {
+  detail::bulkMulRaw(reinterpret_cast<uint32_t*>(out), in, count, detail::kEncodeFactor);
+}
+
+/// Convert count Fp values to plain values, i.e. out[i] = in[i].asUInt32().  out may be the same
+/// array as in.
+inline void decodeBulk(uint32_t* out, const Fp* in, size_t count) {
+  detail::bulkMulRaw(out, reinterpret_cast<const uint32_t*>(in), count, detail::kDecodeFactor);
+}
+
+/// Strided version of encodeBulk: out[i * outStride] = Fp(in[i * inStride]).
+inline void encodeBulkStrided(
+    Fp* out, size_t outStride, const uint32_t* in, size_t inStride, size_t count) {
+  detail::bulkMulRawStrided(
+      reinterpret_cast<uint32_t*>(out), outStride, in, inStride, count, detail::kEncodeFactor);
+}
+
+/// Strided version of decodeBulk: out[i * outStride] = in[i * inStride].asUInt32().
+inline void decodeBulkStrided(
+    uint32_t* out, size_t outStride, const Fp* in, size_t inStride, size_t count) {
+  detail::bulkMulRawStrided(out,
+                            outStride,
+                            reinterpret_cast<const uint32_t*>(in),
+                            inStride,
+                            count,
+                            detail::kDecodeFactor);
+}
+
+} // namespace risc0
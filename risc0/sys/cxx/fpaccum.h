@@ -0,0 +1,108 @@
+// Copyright 2025 RISC Zero, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/// \file
+/// Defines FpAccum and FpExtAccum, accumulators for sums of products which defer the modular
+/// reduction until the final result is needed.
+
+#include "fp.h"
+#include "fpext.h"
+
+#include <cstdint>
+
+namespace risc0 {
+
+/// FpAccum computes sums of the form a0 * b0 + a1 * b1 + ... without reducing each product.
+///
+/// Each Fp is stored as x * 2^32 mod P (Montgomery form), so the product of two raw values is the
+/// (unreduced) raw form of the product times 2^32.  Those 62-bit products are summed into a 64-bit
+/// word, counting the carries out of the top bit separately.  Only reduce() does any modular
+/// arithmetic: one Montgomery reduction of the low word, plus the carries (each worth 2^64, which
+/// is 2^32 * 2^32) added back in as the Fp value 'carry'.  Up to 2^32 terms may be accumulated.
+class FpAccum {
+  // The 2^32 multiple of P, which is subtracted from 'low' before reducing.
+  static constexpr uint64_t PSHIFT = uint64_t(Fp::P) << 32;
+
+  uint64_t low;
+  uint32_t carry;
+
+public:
+  /// Default constructor, sets the sum to 0.
+  constexpr FpAccum() : low(0), carry(0) {}
+
+  /// Add a * b to the sum.
+  constexpr inline void mulAdd(Fp a, Fp b) {
+    uint64_t prod = uint64_t(a.asRaw()) * uint64_t(b.asRaw());
+    low += prod;
+    carry += low < prod;
+  }
+
+  /// Add a to the sum.
+  constexpr inline void add(Fp a) { mulAdd(a, Fp(1)); }
+
+  /// Reduce the sum to an Fp.
+  constexpr inline Fp reduce() const {
+    // low < 2^64 < 3 * PSHIFT, so two subtractions bring it into range for fromReduced.
+    uint64_t x = low;
+    x = (x >= PSHIFT ? x - PSHIFT : x);
+    x = (x >= PSHIFT ? x - PSHIFT : x);
+    return Fp::fromReduced(x) + Fp(carry);
+  }
+};
+
+/// FpExtAccum computes sums of products of FpExt values without reducing each product.
+///
+/// Multiplying two FpExt values is a polynomial multiply producing 7 coefficients, followed by a
+/// reduction modulo x^4 - 11 (see FpExt::operator*).  Here the 7 coefficients are accumulated with
+/// FpAccum, and both the modular reduction and the polynomial reduction happen once in reduce().
+class FpExtAccum {
+  FpAccum coeffs[7];
+
+public:
+  /// Default constructor, sets the sum to 0.
+  constexpr FpExtAccum() {}
+
+  /// Add a * b to the sum.
+  constexpr inline void mulAdd(FpExt a, FpExt b) {
+    for (size_t i = 0; i < 4; i++) {
+      for (size_t j = 0; j < 4; j++) {
+        coeffs[i + j].mulAdd(a.elems[i], b.elems[j]);
+      }
+    }
+  }
+
+  /// Add a * b to the sum, where b is in the base field.
+  constexpr inline void mulAdd(FpExt a, Fp b) {
+    for (size_t i = 0; i < 4; i++) {
+      coeffs[i].mulAdd(a.elems[i], b);
+    }
+  }
+
+  /// Add a to the sum.
+  constexpr inline void add(FpExt a) { mulAdd(a, Fp(1)); }
+
+  /// Reduce the sum to an FpExt.
+  constexpr inline FpExt reduce() const {
+    // x^4 == 11, so the coefficient of x^(i+4) folds into x^i multiplied by -11.
+    Fp nbeta(Fp::P - 11);
+    return FpExt(coeffs[0].reduce() + nbeta * coeffs[4].reduce(),
+                 coeffs[1].reduce() + nbeta * coeffs[5].reduce(),
+                 coeffs[2].reduce() + nbeta * coeffs[6].reduce(),
+                 coeffs[3].reduce());
+  }
+};
+
+} // namespace risc0
@@ -0,0 +1,229 @@
+// Copyright 2025 RISC Zero, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/// \file
+/// Defines FpExtVec, a packed vector of FpExt elements stored as a structure of arrays.
+
+#include "fp.h"
+#include "fpext.h"
+#include "fpvec.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace risc0 {
+
+/// An FpExtVec<N> holds N independent FpExt values (lanes).  Rather than N copies of FpExt's
+/// elems[4], it holds 4 FpVec<N>, one per coefficient.  This matches the way extension elements are
+/// laid out in column-major witness and check buffers, where each coefficient is its own column:
+/// N consecutive rows of an extension value are 4 contiguous runs of N elements, one per column,
+/// so they can be loaded and stored without any gather or scatter.
+template <size_t N> struct FpExtVec {
+  static constexpr size_t LANES = N;
+
+  /// The coefficient vectors, elems[j] holds coefficient j of every lane.
+  FpVec<N> elems[4];
+
+  /// Default constructor, sets all lanes to 0.
+  FpExtVec() {}
+
+  /// Broadcast a single value to every lane.
+  FpExtVec(FpExt x) {
+    for (size_t j = 0; j < 4; j++) {
+      elems[j] = FpVec<N>(x.elems[j]);
+    }
+  }
+
+  /// Broadcast a small integer to every lane.
+  explicit constexpr FpExtVec(uint32_t x) : elems{FpVec<N>(Fp(x))} {}
+
+  /// Promote a vector of base field values.
+  FpExtVec(FpVec<N> x) { elems[0] = x; }
+
+  /// Broadcast the extension element with coefficients a, b, c and d to every lane.  Unlike the
+  /// broadcast of an FpExt, this is constexpr.
+  constexpr FpExtVec(Fp a, Fp b, Fp c, Fp d)
+      : elems{FpVec<N>(a), FpVec<N>(b), FpVec<N>(c), FpVec<N>(d)} {}
+
+  /// Construct from the four coefficient vectors.
+  FpExtVec(FpVec<N> a, FpVec<N> b, FpVec<N> c, FpVec<N> d) {
+    elems[0] = a;
+    elems[1] = b;
+    elems[2] = c;
+    elems[3] = d;
+  }
+
+  /// Load N consecutive rows from 4 columns: coefficient j of lane i is read from
+  /// col0[j * colStride + i].  For a column-major buffer colStride is the number of rows.
+  static inline FpExtVec load(const Fp* col0, size_t colStride) {
+    FpExtVec ret;
+    for (size_t j = 0; j < 4; j++) {
+      ret.elems[j] = FpVec<N>::load(col0 + j * colStride);
+    }
+    return ret;
+  }
+
+  /// Store N consecutive rows into 4 columns, the inverse of load.
+  inline void store(Fp* col0, size_t colStride) const {
+    for (size_t j = 0; j < 4; j++) {
+      elems[j].store(col0 + j * colStride);
+    }
+  }
+
+  /// Load N consecutive elements from an array of FpExt.
+  static inline FpExtVec loadPacked(const FpExt* ptr) {
+    Fp cols[4][N];
+    for (size_t i = 0; i < N; i++) {
+      for (size_t j = 0; j < 4; j++) {
+        cols[j][i] = ptr[i].elems[j];
+      }
+    }
+    return load(&cols[0][0], N);
+  }
+
+  /// Store N consecutive elements to an array of FpExt.
+  inline void storePacked(FpExt* ptr) const {
+    Fp cols[4][N];
+    store(&cols[0][0], N);
+    for (size_t i = 0; i < N; i++) {
+      for (size_t j = 0; j < 4; j++) {
+        ptr[i].elems[j] = cols[j][i];
+      }
+    }
+  }
+
+  /// Extract a single lane.
+  inline FpExt operator[](size_t i) const {
+    return FpExt(elems[0][i], elems[1][i], elems[2][i], elems[3][i]);
+  }
+
+  inline FpExtVec operator+(FpExtVec rhs) const {
+    FpExtVec ret;
+    for (size_t j = 0; j < 4; j++) {
+      ret.elems[j] = elems[j] + rhs.elems[j];
+    }
+    return ret;
+  }
+
+  inline FpExtVec operator-() const {
+    FpExtVec ret;
+    for (size_t j = 0; j < 4; j++) {
+      ret.elems[j] = -elems[j];
+    }
+    return ret;
+  }
+
+  inline FpExtVec operator-(FpExtVec rhs) const {
+    FpExtVec ret;
+    for (size_t j = 0; j < 4; j++) {
+      ret.elems[j] = elems[j] - rhs.elems[j];
+    }
+    return ret;
+  }
+
+  /// Add a per-lane base field value, which only touches the first coefficient.
+  inline FpExtVec operator+(FpVec<N> rhs) const {
+    FpExtVec ret = *this;
+    ret.elems[0] += rhs;
+    return ret;
+  }
+
+  /// Subtract a per-lane base field value, which only touches the first coefficient.
+  inline FpExtVec operator-(FpVec<N> rhs) const {
+    FpExtVec ret = *this;
+    ret.elems[0] -= rhs;
+    return ret;
+  }
+
+  /// Multiply every lane by a per-lane base field value.
+  inline FpExtVec operator*(FpVec<N> rhs) const {
+    FpExtVec ret;
+    for (size_t j = 0; j < 4; j++) {
+      ret.elems[j] = elems[j] * rhs;
+    }
+    return ret;
+  }
+
+  // See FpExt::operator* for the reduction modulo x^4 - 11.  Each lane-wise multiply is already
+  // fully reduced, so this is the plain schoolbook form: 16 products + 3 for the reduction by beta.
+  inline FpExtVec operator*(FpExtVec rhs) const {
+#define a elems
+#define b rhs.elems
+    FpVec<N> nbeta(Fp(Fp::P - 11));
+    FpVec<N> c4 = a[1] * b[3] + a[2] * b[2] + a[3] * b[1];
+    FpVec<N> c5 = a[2] * b[3] + a[3] * b[2];
+    FpVec<N> c6 = a[3] * b[3];
+    return FpExtVec(a[0] * b[0] + nbeta * c4,
+                    a[0] * b[1] + a[1] * b[0] + nbeta * c5,
+                    a[0] * b[2] + a[1] * b[1] + a[2] * b[0] + nbeta * c6,
+                    a[0] * b[3] + a[1] * b[2] + a[2] * b[1] + a[3] * b[0]);
+#undef a
+#undef b
+  }
+
+  inline FpExtVec operator+=(FpExtVec rhs) { return *this = *this + rhs; }
+  inline FpExtVec operator-=(FpExtVec rhs) { return *this = *this - rhs; }
+  inline FpExtVec operator*=(FpExtVec rhs) { return *this = *this * rhs; }
+  inline FpExtVec operator*=(FpVec<N> rhs) { return *this = *this * rhs; }
+};
+
+/// The widest FpExtVec supported by the build target, see FpVecNative.
+using FpExtVecNative = FpExtVec<FpVecNative::LANES>;
+
+template <size_t N> inline FpExtVec<N> operator*(FpVec<N> a, FpExtVec<N> b) {
+  return b * a;
+}
+
+template <size_t N> inline FpExtVec<N> operator+(FpVec<N> a, FpExtVec<N> b) {
+  return b + a;
+}
+
+template <size_t N> inline FpExtVec<N> operator-(FpVec<N> a, FpExtVec<N> b) {
+  return a + (-b);
+}
+
+/// Compute the multiplicative inverse of every lane, see inv(FpExt).  Zero lanes invert to zero.
+template <size_t N> inline FpExtVec<N> inv(FpExtVec<N> in) {
+#define a in.elems
+  FpVec<N> beta(Fp(11));
+  FpVec<N> nbeta(Fp(Fp::P - 11));
+  FpVec<N> b0 = a[0] * a[0] + beta * (a[1] * (a[3] + a[3]) - a[2] * a[2]);
+  FpVec<N> b2 = a[0] * (a[2] + a[2]) - a[1] * a[1] + beta * (a[3] * a[3]);
+  FpVec<N> c = b0 * b0 + beta * b2 * b2;
+  FpVec<N> ic = inv(c);
+  b0 *= ic;
+  b2 *= ic;
+  return FpExtVec<N>(a[0] * b0 + beta * a[2] * b2,
+                     -a[1] * b0 + nbeta * a[3] * b2,
+                     -a[0] * b2 + a[2] * b0,
+                     a[1] * b2 - a[3] * b0);
+#undef a
+}
+
+/// Raise every lane to the same power
+template <size_t N> inline FpExtVec<N> pow(FpExtVec<N> x, size_t n) {
+  FpExtVec<N> tot(FpExt(1));
+  while (n != 0) {
+    if (n % 2 == 1) {
+      tot *= x;
+    }
+    n = n / 2;
+    x *= x;
+  }
+  return tot;
+}
+
+} // namespace risc0
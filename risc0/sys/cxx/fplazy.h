@@ -0,0 +1,170 @@
+// Copyright 2025 RISC Zero, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/// \file
+/// Defines FpLazy, a partially reduced form of Fp for long chains of arithmetic.
+
+#include "fp.h"
+
+#include <cstdint>
+#include <type_traits>
+
+namespace risc0 {
+
+/// An FpLazy<K> holds the same value as an Fp, but only partially reduced: the Montgomery form is
+/// kept in a 64-bit integer in the range [0, K * P) rather than [0, P).  The bound K is tracked at
+/// compile time, so addition and subtraction never need a comparison; they just produce a wider
+/// bound.  Multiplication only needs its inputs small enough for a Montgomery reduction, and its
+/// result is left in [0, 2P) without the final conditional subtraction.  Values are canonicalized
+/// only when converted back to Fp, compared, or read with asUInt32(), which takes one conditional
+/// subtraction per bit of K - 1.
+///
+/// Since P is close to 2^31, a 32-bit redundant form would overflow on the first addition, which is
+/// why the wider storage is used.  This makes FpLazy best suited for scalar straight-line code like
+/// the generated step and poly functions, rather than for storage.
+template <uint64_t K> class FpLazy {
+  static_assert(K >= 1 && K <= (uint64_t(1) << 32), "FpLazy bound out of range");
+
+  template <uint64_t J> friend class FpLazy;
+
+  // The partially reduced value, always < K * P.
+  uint64_t val;
+
+  // A private constructor that take the 'internal' form.
+  constexpr inline FpLazy(uint64_t val, bool /*ignore*/) : val(val) {}
+
+  // Montgomery reduce without the final conditional subtraction, x must be < P * 2^32 and the
+  // result is < 2P.
+  static constexpr inline uint64_t reduce(uint64_t x) {
+    uint32_t red = Fp::M * -uint32_t(x);
+    return (x + uint64_t(red) * uint64_t(Fp::P)) >> 32;
+  }
+
+  // The smallest c with K <= 2^c.
+  static constexpr inline uint32_t log2Bound() {
+    uint32_t c = 0;
+    while ((uint64_t(1) << c) < K) {
+      c++;
+    }
+    return c;
+  }
+
+  // Bring x from [0, K * P) down to [0, 2^t * P) by conditionally subtracting P * 2^i for each i
+  // from log2Bound() - 1 down to t.  Each step halves the bound, and compiles to a compare and a
+  // select rather than the hardware divide that x % P would need.
+  template <uint32_t t> static constexpr inline uint64_t shrink(uint64_t x) {
+    for (uint32_t i = log2Bound(); i-- > t;) {
+      uint64_t sub = uint64_t(Fp::P) << i;
+      x = (x >= sub ? x - sub : x);
+    }
+    return x;
+  }
+
+public:
+  static constexpr uint64_t BOUND = K;
+
+  /// Default constructor, sets value to 0.
+  constexpr inline FpLazy() : val(0) {}
+
+  /// Convert from a (fully reduced) Fp.
+  constexpr inline FpLazy(Fp x) : val(x.asRaw()) {}
+
+  /// Widen from a tighter bound.
+  template <uint64_t J, typename = std::enable_if_t<J <= K>>
+  constexpr inline FpLazy(FpLazy<J> x) : val(x.val) {}
+
+  /// Fully reduce to an Fp.
+  constexpr inline Fp canonical() const { return Fp::fromRaw(shrink<0>(val)); }
+
+  constexpr inline operator Fp() const { return canonical(); }
+
+  /// Convert to a uint32_t
+  constexpr inline uint32_t asUInt32() const { return canonical().asUInt32(); }
+
+  template <uint64_t J> constexpr inline FpLazy<K + J> operator+(FpLazy<J> rhs) const {
+    return FpLazy<K + J>(val + rhs.val, true);
+  }
+
+  template <uint64_t J> constexpr inline FpLazy<K + J> operator-(FpLazy<J> rhs) const {
+    return FpLazy<K + J>(val + (J * Fp::P - rhs.val), true);
+  }
+
+  constexpr inline FpLazy<K + 1> operator-() const { return FpLazy<K + 1>(K * Fp::P - val, true); }
+
+  template <uint64_t J> constexpr inline FpLazy<2> operator*(FpLazy<J> rhs) const {
+    // Bring the inputs down to [0, P) x [0, 2P), so that a * b < 2 * P^2 < P * 2^32 can be reduced
+    // as is.  This is free when K * J <= 2.  K and J are each compared first because K * J may
+    // overflow.
+    if constexpr (K <= 2 && J <= 2 && K * J <= 2) {
+      return FpLazy<2>(reduce(val * rhs.val), true);
+    } else {
+      uint64_t a = shrink<0>(val);
+      uint64_t b = FpLazy<J>::template shrink<1>(rhs.val);
+      return FpLazy<2>(reduce(a * b), true);
+    }
+  }
+
+  template <uint64_t J> constexpr inline bool operator==(FpLazy<J> rhs) const {
+    return canonical() == rhs.canonical();
+  }
+
+  template <uint64_t J> constexpr inline bool operator!=(FpLazy<J> rhs) const {
+    return canonical() != rhs.canonical();
+  }
+};
+
+// Mixed Fp / FpLazy overloads, which treat the Fp as an FpLazy<1>.
+template <uint64_t K> constexpr inline FpLazy<K + 1> operator+(FpLazy<K> a, Fp b) {
+  return a + FpLazy<1>(b);
+}
+
+template <uint64_t K> constexpr inline FpLazy<K + 1> operator+(Fp a, FpLazy<K> b) {
+  return FpLazy<1>(a) + b;
+}
+
+template <uint64_t K> constexpr inline FpLazy<K + 1> operator-(FpLazy<K> a, Fp b) {
+  return a - FpLazy<1>(b);
+}
+
+template <uint64_t K> constexpr inline FpLazy<K + 1> operator-(Fp a, FpLazy<K> b) {
+  return FpLazy<1>(a) - b;
+}
+
+template <uint64_t K> constexpr inline FpLazy<2> operator*(FpLazy<K> a, Fp b) {
+  return a * FpLazy<1>(b);
+}
+
+template <uint64_t K> constexpr inline FpLazy<2> operator*(Fp a, FpLazy<K> b) {
+  return FpLazy<1>(a) * b;
+}
+
+template <uint64_t K> constexpr inline bool operator==(FpLazy<K> a, Fp b) {
+  return a.canonical() == b;
+}
+
+template <uint64_t K> constexpr inline bool operator==(Fp a, FpLazy<K> b) {
+  return a == b.canonical();
+}
+
+template <uint64_t K> constexpr inline bool operator!=(FpLazy<K> a, Fp b) {
+  return a.canonical() != b;
+}
+
+template <uint64_t K> constexpr inline bool operator!=(Fp a, FpLazy<K> b) {
+  return a != b.canonical();
+}
+
+} // namespace risc0
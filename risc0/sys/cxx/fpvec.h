@@ -0,0 +1,289 @@
+// Copyright 2025 RISC Zero, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/// \file
+/// Defines FpVec, a packed vector of Fp elements which are operated on lane-wise.
+
+#include "fp.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+// The SIMD broadcasts below are vector literals on GCC and Clang, which unlike the set1 intrinsics
+// can be constexpr, so that broadcast constants can be constexpr as they are for Fp.  Vector
+// literals are an extension, so other compilers fall back to the intrinsics, and the broadcasts are
+// not constexpr there.
+#if defined(__GNUC__)
+#define RISC0_FPVEC_SPLAT constexpr
+#else
+#define RISC0_FPVEC_SPLAT inline
+#endif
+
+namespace risc0 {
+
+static_assert(sizeof(Fp) == sizeof(uint32_t), "FpVec requires Fp to be a bare uint32_t");
+
+/// An FpVec<N> holds N independent Fp values (lanes) and implements the same arithmetic surface as
+/// Fp, applied to every lane at once.  It is intended for CPU kernels which run the same
+/// straight-line field arithmetic over many consecutive rows: load N rows, compute, store N rows.
+///
+/// Values are kept in the same Montgomery form as Fp, so loading from and storing to Fp buffers is
+/// a plain memory copy.  The generic template below is a portable scalar fallback; AVX2 (8 lanes)
+/// and AVX-512 (16 lanes) specializations are selected at compile time when the target supports
+/// them.  Use FpVecNative to get the widest vector the build target supports.
+template <size_t N> struct FpVec {
+  static constexpr size_t LANES = N;
+
+  Fp lanes[N];
+
+  /// Default constructor, sets all lanes to 0.
+  constexpr FpVec() {}
+
+  /// Broadcast a single value to every lane.
+  constexpr FpVec(Fp x) {
+    for (size_t i = 0; i < N; i++) {
+      lanes[i] = x;
+    }
+  }
+
+  /// Load N consecutive elements.
+  static inline FpVec load(const Fp* ptr) {
+    FpVec ret;
+    for (size_t i = 0; i < N; i++) {
+      ret.lanes[i] = ptr[i];
+    }
+    return ret;
+  }
+
+  /// Store N consecutive elements.
+  inline void store(Fp* ptr) const {
+    for (size_t i = 0; i < N; i++) {
+      ptr[i] = lanes[i];
+    }
+  }
+
+  /// Extract a single lane.
+  constexpr Fp operator[](size_t i) const { return lanes[i]; }
+
+  constexpr FpVec operator+(FpVec rhs) const {
+    FpVec ret;
+    for (size_t i = 0; i < N; i++) {
+      ret.lanes[i] = lanes[i] + rhs.lanes[i];
+    }
+    return ret;
+  }
+
+  constexpr FpVec operator-() const {
+    FpVec ret;
+    for (size_t i = 0; i < N; i++) {
+      ret.lanes[i] = -lanes[i];
+    }
+    return ret;
+  }
+
+  constexpr FpVec operator-(FpVec rhs) const {
+    FpVec ret;
+    for (size_t i = 0; i < N; i++) {
+      ret.lanes[i] = lanes[i] - rhs.lanes[i];
+    }
+    return ret;
+  }
+
+  constexpr FpVec operator*(FpVec rhs) const {
+    FpVec ret;
+    for (size_t i = 0; i < N; i++) {
+      ret.lanes[i] = lanes[i] * rhs.lanes[i];
+    }
+    return ret;
+  }
+
+  constexpr FpVec operator+=(FpVec rhs) { return *this = *this + rhs; }
+  constexpr FpVec operator-=(FpVec rhs) { return *this = *this - rhs; }
+  constexpr FpVec operator*=(FpVec rhs) { return *this = *this * rhs; }
+};
+
+#if defined(__AVX2__)
+
+/// AVX2 backend: 8 lanes in a single 256-bit register.
+template <> struct FpVec<8> {
+  static constexpr size_t LANES = 8;
+
+  __m256i v;
+
+  inline FpVec() : v(_mm256_setzero_si256()) {}
+  RISC0_FPVEC_SPLAT FpVec(Fp x) : v(splat(int32_t(x.asRaw()))) {}
+  explicit inline FpVec(__m256i v) : v(v) {}
+
+  static inline FpVec load(const Fp* ptr) {
+    return FpVec(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr)));
+  }
+
+  inline void store(Fp* ptr) const { _mm256_storeu_si256(reinterpret_cast<__m256i*>(ptr), v); }
+
+  inline Fp operator[](size_t i) const {
+    Fp tmp[LANES];
+    store(tmp);
+    return tmp[i];
+  }
+
+  // _mm256_set1_epi32, as a vector literal where it can be, see RISC0_FPVEC_SPLAT.
+  static RISC0_FPVEC_SPLAT __m256i splat(int32_t x) {
+#if defined(__GNUC__)
+    return __m256i(__v8si{x, x, x, x, x, x, x, x});
+#else
+    return _mm256_set1_epi32(x);
+#endif
+  }
+
+  // The reductions below use the unsigned-min trick: for a candidate r and its corrected form r',
+  // exactly one of the two is in [0, P), and it is always the smaller of the two as unsigned ints.
+  static inline __m256i add(__m256i a, __m256i b) {
+    __m256i r = _mm256_add_epi32(a, b);
+    return _mm256_min_epu32(r, _mm256_sub_epi32(r, _mm256_set1_epi32(Fp::P)));
+  }
+
+  static inline __m256i sub(__m256i a, __m256i b) {
+    __m256i r = _mm256_sub_epi32(a, b);
+    return _mm256_min_epu32(r, _mm256_add_epi32(r, _mm256_set1_epi32(Fp::P)));
+  }
+
+  // Montgomery multiply.  _mm256_mul_epu32 only multiplies the even 32-bit lanes, so the odd lanes
+  // are shifted down and done as a second batch.  Since q = lo(a * b) * P^-1, the low halves of
+  // a * b and q * P are equal, and the difference of the high halves is in (-P, P).
+  static inline __m256i mul(__m256i a, __m256i b) {
+    const __m256i p = _mm256_set1_epi32(Fp::P);
+    const __m256i m = _mm256_set1_epi32(Fp::M);
+    __m256i prodEven = _mm256_mul_epu32(a, b);
+    __m256i prodOdd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+    __m256i qpEven = _mm256_mul_epu32(_mm256_mul_epu32(prodEven, m), p);
+    __m256i qpOdd = _mm256_mul_epu32(_mm256_mul_epu32(prodOdd, m), p);
+    __m256i dEven = _mm256_srli_epi64(_mm256_sub_epi32(prodEven, qpEven), 32);
+    __m256i dOdd = _mm256_sub_epi32(prodOdd, qpOdd);
+    __m256i r = _mm256_blend_epi32(dEven, dOdd, 0xaa);
+    return _mm256_min_epu32(r, _mm256_add_epi32(r, p));
+  }
+
+  inline FpVec operator+(FpVec rhs) const { return FpVec(add(v, rhs.v)); }
+  inline FpVec operator-() const { return FpVec(sub(_mm256_setzero_si256(), v)); }
+  inline FpVec operator-(FpVec rhs) const { return FpVec(sub(v, rhs.v)); }
+  inline FpVec operator*(FpVec rhs) const { return FpVec(mul(v, rhs.v)); }
+
+  inline FpVec operator+=(FpVec rhs) { return *this = *this + rhs; }
+  inline FpVec operator-=(FpVec rhs) { return *this = *this - rhs; }
+  inline FpVec operator*=(FpVec rhs) { return *this = *this * rhs; }
+};
+
+#endif // __AVX2__
+
+#if defined(__AVX512F__)
+
+/// AVX-512 backend: 16 lanes in a single 512-bit register.
+template <> struct FpVec<16> {
+  static constexpr size_t LANES = 16;
+
+  __m512i v;
+
+  inline FpVec() : v(_mm512_setzero_si512()) {}
+  RISC0_FPVEC_SPLAT FpVec(Fp x) : v(splat(int32_t(x.asRaw()))) {}
+  explicit inline FpVec(__m512i v) : v(v) {}
+
+  static inline FpVec load(const Fp* ptr) { return FpVec(_mm512_loadu_si512(ptr)); }
+
+  inline void store(Fp* ptr) const { _mm512_storeu_si512(ptr, v); }
+
+  inline Fp operator[](size_t i) const {
+    Fp tmp[LANES];
+    store(tmp);
+    return tmp[i];
+  }
+
+  // See FpVec<8>::splat.
+  static RISC0_FPVEC_SPLAT __m512i splat(int32_t x) {
+#if defined(__GNUC__)
+    return __m512i(__v16si{x, x, x, x, x, x, x, x, x, x, x, x, x, x, x, x});
+#else
+    return _mm512_set1_epi32(x);
+#endif
+  }
+
+  // See FpVec<8> for an explanation of the reductions.
+  static inline __m512i add(__m512i a, __m512i b) {
+    __m512i r = _mm512_add_epi32(a, b);
+    return _mm512_min_epu32(r, _mm512_sub_epi32(r, _mm512_set1_epi32(Fp::P)));
+  }
+
+  static inline __m512i sub(__m512i a, __m512i b) {
+    __m512i r = _mm512_sub_epi32(a, b);
+    return _mm512_min_epu32(r, _mm512_add_epi32(r, _mm512_set1_epi32(Fp::P)));
+  }
+
+  static inline __m512i mul(__m512i a, __m512i b) {
+    const __m512i p = _mm512_set1_epi32(Fp::P);
+    const __m512i m = _mm512_set1_epi32(Fp::M);
+    __m512i prodEven = _mm512_mul_epu32(a, b);
+    __m512i prodOdd = _mm512_mul_epu32(_mm512_srli_epi64(a, 32), _mm512_srli_epi64(b, 32));
+    __m512i qpEven = _mm512_mul_epu32(_mm512_mul_epu32(prodEven, m), p);
+    __m512i qpOdd = _mm512_mul_epu32(_mm512_mul_epu32(prodOdd, m), p);
+    __m512i dEven = _mm512_srli_epi64(_mm512_sub_epi32(prodEven, qpEven), 32);
+    __m512i dOdd = _mm512_sub_epi32(prodOdd, qpOdd);
+    __m512i r = _mm512_mask_blend_epi32(0xaaaa, dEven, dOdd);
+    return _mm512_min_epu32(r, _mm512_add_epi32(r, p));
+  }
+
+  inline FpVec operator+(FpVec rhs) const { return FpVec(add(v, rhs.v)); }
+  inline FpVec operator-() const { return FpVec(sub(_mm512_setzero_si512(), v)); }
+  inline FpVec operator-(FpVec rhs) const { return FpVec(sub(v, rhs.v)); }
+  inline FpVec operator*(FpVec rhs) const { return FpVec(mul(v, rhs.v)); }
+
+  inline FpVec operator+=(FpVec rhs) { return *this = *this + rhs; }
+  inline FpVec operator-=(FpVec rhs) { return *this = *this - rhs; }
+  inline FpVec operator*=(FpVec rhs) { return *this = *this * rhs; }
+};
+
+#endif // __AVX512F__
+
+/// The widest FpVec supported by the build target.  The scalar fallback still uses 8 lanes so that
+/// kernels see the same blocking regardless of target, and the compiler is free to auto-vectorize
+/// the lane loops.
+#if defined(__AVX512F__)
+using FpVecNative = FpVec<16>;
+#else
+using FpVecNative = FpVec<8>;
+#endif
+
+/// Raise every lane to the same power
+template <size_t N> inline FpVec<N> pow(FpVec<N> x, size_t n) {
+  FpVec<N> tot(Fp(1));
+  while (n != 0) {
+    if (n % 2 == 1) {
+      tot *= x;
+    }
+    n = n / 2;
+    x *= x;
+  }
+  return tot;
+}
+
+/// Compute the multiplicative inverse of every lane, see inv(Fp).  Zero lanes invert to zero.
+template <size_t N> inline FpVec<N> inv(FpVec<N> x) {
+  return powPMinus2(x);
+}
+
+} // namespace risc0
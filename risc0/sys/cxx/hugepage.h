@@ -0,0 +1,144 @@
+// Copyright 2025 RISC Zero, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/// \file
+/// Huge-page backed allocation for the large prover matrices.  The witness and check buffers are
+/// walked a column at a time, so with 4 KiB pages nearly every strided access needs its own TLB
+/// entry.  Backing them with 2 MiB or 1 GiB pages cuts the number of entries needed by orders of
+/// magnitude.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace risc0 {
+
+/// The kind of pages that ended up backing an allocation.
+enum class PageKind : uint32_t {
+  // Ordinary pages.
+  Normal = 0,
+  // Ordinary pages, with transparent huge pages requested by madvise(MADV_HUGEPAGE).  The kernel
+  // promotes them to 2 MiB pages when it can, but doesn't promise to.
+  Transparent = 1,
+  // Explicit 2 MiB pages from the hugetlb pool.
+  Huge2M = 2,
+  // Explicit 1 GiB pages from the hugetlb pool.
+  Huge1G = 3,
+};
+
+/// A mapping made by hugeAlloc.  len is the mapped length, which is rounded up to the page size.
+struct HugeAlloc {
+  void* ptr;
+  size_t len;
+  PageKind kind;
+};
+
+namespace detail {
+
+constexpr size_t kPage2M = size_t(1) << 21;
+constexpr size_t kPage1G = size_t(1) << 30;
+
+inline size_t roundUp(size_t bytes, size_t align) {
+  return (bytes + align - 1) & ~(align - 1);
+}
+
+#if defined(__linux__)
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+
+// Map len bytes of explicit huge pages of 1 << log2Page bytes.  This fails unless the hugetlb pool
+// for that size has enough free pages.
+inline void* mapHugeTlb(size_t len, int log2Page) {
+  void* ptr = mmap(nullptr,
+                   len,
+                   PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (log2Page << MAP_HUGE_SHIFT),
+                   -1,
+                   0);
+  return ptr == MAP_FAILED ? nullptr : ptr;
+}
+
+// Map len bytes of ordinary pages at a 2 MiB aligned address, which transparent huge pages need.
+// The mapping is made one huge page too long, and the unaligned ends are trimmed off.
+inline void* mapAligned(size_t len) {
+  size_t padded = len + kPage2M;
+  void* raw = mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (raw == MAP_FAILED) {
+    return nullptr;
+  }
+  uintptr_t begin = reinterpret_cast<uintptr_t>(raw);
+  uintptr_t aligned = roundUp(begin, kPage2M);
+  if (aligned > begin) {
+    munmap(raw, aligned - begin);
+  }
+  size_t tail = begin + padded - (aligned + len);
+  if (tail) {
+    munmap(reinterpret_cast<void*>(aligned + len), tail);
+  }
+  return reinterpret_cast<void*>(aligned);
+}
+
+#endif
+
+} // namespace detail
+
+/// Map bytes of zeroed memory on the largest pages that are available, falling back in turn from
+/// explicit 1 GiB pages (only when at most an eighth of the last page is wasted), to explicit 2 MiB
+/// pages, to transparent huge pages, to ordinary pages.  The kind that was used is reported in the
+/// result.  On failure ptr is null.  Nothing is touched here, so pages are placed by first touch.
+inline HugeAlloc hugeAlloc(size_t bytes) {
+#if defined(__linux__)
+  size_t len1G = detail::roundUp(bytes, detail::kPage1G);
+  if (bytes >= detail::kPage1G && len1G - bytes <= len1G / 8) {
+    if (void* ptr = detail::mapHugeTlb(len1G, 30)) {
+      return {ptr, len1G, PageKind::Huge1G};
+    }
+  }
+  size_t len2M = detail::roundUp(bytes, detail::kPage2M);
+  if (void* ptr = detail::mapHugeTlb(len2M, 21)) {
+    return {ptr, len2M, PageKind::Huge2M};
+  }
+  void* ptr = detail::mapAligned(len2M);
+  if (!ptr) {
+    return {nullptr, 0, PageKind::Normal};
+  }
+  if (madvise(ptr, len2M, MADV_HUGEPAGE) != 0) {
+    return {ptr, len2M, PageKind::Normal};
+  }
+  return {ptr, len2M, PageKind::Transparent};
+#else
+  return {std::calloc(bytes, 1), bytes, PageKind::Normal};
+#endif
+}
+
+/// Release a mapping made by hugeAlloc.
+inline void hugeFree(const HugeAlloc& alloc) {
+#if defined(__linux__)
+  if (alloc.ptr) {
+    munmap(alloc.ptr, alloc.len);
+  }
+#else
+  std::free(alloc.ptr);
+#endif
+}
+
+} // namespace risc0
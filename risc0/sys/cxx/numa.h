@@ -0,0 +1,310 @@
+// Copyright 2025 RISC Zero, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/// \file
+/// NUMA placement for the CPU prover.  On a host with more than one NUMA node, a host may opt in to
+/// pinning the threads of the poolstl pool to nodes with pinWorkers.  Once it has, buffers are
+/// first touched by the threads which will later process them, so that each page lands on the node
+/// that uses it.  Set RISC0_NUMA=0 to disable the pinning even when it is asked for.
+
+#if defined(__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wmissing-braces"
+#elif defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-braces"
+#endif
+
+#include "vendor/poolstl.hpp"
+
+#if defined(__clang__)
+#pragma clang diagnostic pop
+#elif defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace risc0::numa {
+
+/// The CPUs of each NUMA node that this process is allowed to run on.  Nodes without any such CPU
+/// are left out, and where the topology can't be read there are no nodes at all.
+class Topology {
+public:
+  /// The topology of the host.
+  static const Topology& get() {
+    static Topology topology;
+    return topology;
+  }
+
+  /// A topology with the given CPUs in each node, such as a fake one for tests.
+  explicit Topology(std::vector<std::vector<int>> nodeCpus) : nodeCpus(std::move(nodeCpus)) {}
+
+  size_t nodes() const { return nodeCpus.size(); }
+
+  const std::vector<int>& cpus(size_t node) const { return nodeCpus[node]; }
+
+private:
+  std::vector<std::vector<int>> nodeCpus;
+
+  Topology() {
+#if defined(__linux__)
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+      return;
+    }
+    std::vector<int> ids;
+    if (DIR* dir = opendir("/sys/devices/system/node")) {
+      while (dirent* entry = readdir(dir)) {
+        int id;
+        if (sscanf(entry->d_name, "node%d", &id) == 1) {
+          ids.push_back(id);
+        }
+      }
+      closedir(dir);
+    }
+    std::sort(ids.begin(), ids.end());
+    for (int id : ids) {
+      std::vector<int> cpus = readCpuList(id);
+      cpus.erase(std::remove_if(cpus.begin(),
+                                cpus.end(),
+                                [&](int cpu) {
+                                  return cpu >= CPU_SETSIZE || !CPU_ISSET(cpu, &allowed);
+                                }),
+                 cpus.end());
+      if (!cpus.empty()) {
+        nodeCpus.push_back(std::move(cpus));
+      }
+    }
+#endif
+  }
+
+#if defined(__linux__)
+  // Parse a sysfs cpulist such as "0-3,8-11".
+  static std::vector<int> readCpuList(int node) {
+    std::vector<int> cpus;
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+    FILE* file = fopen(path, "r");
+    if (!file) {
+      return cpus;
+    }
+    int first;
+    while (fscanf(file, "%d", &first) == 1) {
+      int last = first;
+      int sep = fgetc(file);
+      if (sep == '-') {
+        if (fscanf(file, "%d", &last) != 1) {
+          break;
+        }
+        sep = fgetc(file);
+      }
+      for (int cpu = first; cpu <= last; cpu++) {
+        cpus.push_back(cpu);
+      }
+      if (sep != ',') {
+        break;
+      }
+    }
+    fclose(file);
+    return cpus;
+  }
+#endif
+};
+
+namespace detail {
+
+// The slot of a pinned pool thread, in [0, pool threads).
+inline thread_local size_t workerSlot = SIZE_MAX;
+
+struct Pinning {
+  std::once_flag once;
+  std::atomic<size_t> slots{0};
+};
+
+inline Pinning& pinning() {
+  static Pinning state;
+  return state;
+}
+
+} // namespace detail
+
+/// True if the topology has more than one usable NUMA node and RISC0_NUMA is not set to 0.
+inline bool enabled(const Topology& topology = Topology::get()) {
+  const char* env = getenv("RISC0_NUMA");
+  return topology.nodes() > 1 && !(env && strcmp(env, "0") == 0);
+}
+
+/// The node that worker slot slot of slots is pinned to.  Consecutive slots share a node, so the
+/// contiguous ranges that parallelFor hands to neighbouring slots stay on one node.
+inline size_t slotNode(size_t slot, size_t slots, const Topology& topology) {
+  return slot * topology.nodes() / slots;
+}
+
+/// The share of [begin, end) that worker slot slot of slots starts on.  This is the one partition
+/// used both to place the pages of a buffer (see fillRows) and to start a parallelFor on a pinned
+/// pool, so that a worker starts on the rows which were placed on its node.
+inline std::pair<size_t, size_t> slotShare(size_t slot, size_t slots, size_t begin, size_t end) {
+  size_t count = end - begin;
+  return {begin + count * slot / slots, begin + count * (slot + 1) / slots};
+}
+
+/// Run f(index) exactly once on every thread of the pool, with a distinct index in [0, threads)
+/// for each.  Each task waits until all of them have started, which is what keeps two of them off
+/// the same thread, so this must not be called from a task already running on the pool.
+template <typename F> inline void onEachWorker(F f) {
+  task_thread_pool::task_thread_pool* pool = poolstl::par.pool();
+  size_t threads = std::max(1u, pool->get_num_threads());
+  std::mutex lock;
+  std::condition_variable started;
+  size_t arrived = 0;
+  std::vector<std::future<void>> futures;
+  futures.reserve(threads);
+  for (size_t i = 0; i < threads; i++) {
+    futures.push_back(pool->submit([&] {
+      size_t index;
+      {
+        std::unique_lock<std::mutex> guard(lock);
+        index = arrived++;
+        if (arrived == threads) {
+          started.notify_all();
+        } else {
+          started.wait(guard, [&] { return arrived == threads; });
+        }
+      }
+      f(index);
+    }));
+  }
+  std::exception_ptr error;
+  for (auto& future : futures) {
+    try {
+      future.get();
+    } catch (...) {
+      error = std::current_exception();
+    }
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+/// Pin the threads of the pool to the nodes of topology, if enabled(topology).  This is opt-in: it
+/// is never done implicitly, and a host which wants it calls it once at startup, before any work is
+/// submitted to the pool.  It pins the threads of the global pool for the rest of the process, and
+/// only the first call has any effect.  Like onEachWorker, this must not be called from a task
+/// already running on the pool.
+inline void pinWorkers(const Topology& topology = Topology::get()) {
+  detail::Pinning& state = detail::pinning();
+  std::call_once(state.once, [&] {
+    if (!enabled(topology)) {
+      return;
+    }
+#if defined(__linux__)
+    size_t threads = std::max(1u, poolstl::par.pool()->get_num_threads());
+    onEachWorker([&](size_t index) {
+      const std::vector<int>& cpus = topology.cpus(slotNode(index, threads, topology));
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      for (int cpu : cpus) {
+        CPU_SET(cpu, &set);
+      }
+      // Placement is only an optimization, so a failure to pin leaves the thread where it is.
+      pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+      detail::workerSlot = index;
+    });
+    state.slots = threads;
+#endif
+  });
+}
+
+/// The number of pinned worker slots, or zero if the pool is not pinned.
+inline size_t pinnedSlots() {
+  return detail::pinning().slots.load(std::memory_order_acquire);
+}
+
+/// The slot of the calling thread, or SIZE_MAX if it is not a pinned pool thread.
+inline size_t workerSlot() {
+  return detail::workerSlot;
+}
+
+namespace detail {
+
+// Fill the rows x cols column-major buf with value, in slots slotShare shares of the rows, one
+// task per share.  There is no barrier: each task fills the share of its own thread's slot unless
+// another task got there first, and otherwise the first share still free.  A pool thread which runs
+// two of the tasks fills two shares, so the placement is only as good as the pool's scheduling, but
+// the fill always completes.
+template <typename T>
+inline void fillShares(T* buf, size_t rows, size_t cols, T value, size_t slots) {
+  task_thread_pool::task_thread_pool* pool = poolstl::par.pool();
+  std::vector<std::atomic<bool>> taken(slots);
+  auto fillShare = [&] {
+    size_t slot = detail::workerSlot;
+    if (slot >= slots || taken[slot].exchange(true)) {
+      slot = 0;
+      while (taken[slot].exchange(true)) {
+        slot++;
+      }
+    }
+    auto [first, last] = slotShare(slot, slots, 0, rows);
+    for (size_t col = 0; col < cols; col++) {
+      std::fill(buf + col * rows + first, buf + col * rows + last, value);
+    }
+  };
+  std::vector<std::future<void>> futures;
+  futures.reserve(slots);
+  for (size_t i = 0; i < slots; i++) {
+    futures.push_back(pool->submit(fillShare));
+  }
+  for (auto& future : futures) {
+    future.get();
+  }
+}
+
+} // namespace detail
+
+/// Fill a column-major buffer of rows x cols elements with value.  When the pool is pinned, the
+/// rows are filled in slotShare shares, so each share's pages are first touched, and so placed, on
+/// the node of the slot that a uniform-cost parallelFor over the rows starts on them.  Otherwise
+/// this is a plain parallel fill.
+template <typename T> inline void fillRows(T* buf, size_t rows, size_t cols, T value) {
+  size_t slots = pinnedSlots();
+  if (!slots) {
+    std::fill(poolstl::par, buf, buf + rows * cols, value);
+    return;
+  }
+  detail::fillShares(buf, rows, cols, value, slots);
+}
+
+} // namespace risc0::numa
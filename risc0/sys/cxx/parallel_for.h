@@ -0,0 +1,378 @@
+// Copyright 2025 RISC Zero, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/// \file
+/// A work-stealing parallel loop for iterations of uneven cost.
+
+#include "numa.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace risc0 {
+
+namespace detail {
+
+// Each worker owns a contiguous range of the remaining iterations.  The owner takes chunks from the
+// front, and thieves take the back half, so both sides only ever touch the range under its lock.
+struct alignas(64) StealRange {
+  std::mutex lock;
+  size_t begin = 0;
+  size_t end = 0;
+};
+
+// A worker takes 1/kGrainDivisor of its remaining range at a time.  The grain shrinks as the range
+// drains, so a worker starts with large cheap-to-schedule chunks and ends with small ones, which
+// leaves little work stranded behind a slow chunk at the end of the loop.
+constexpr size_t kGrainDivisor = 32;
+
+// Ranges of at least this many iterations are partitioned by cost in parallel.
+constexpr size_t kParallelPartition = 1 << 16;
+
+// The cost of parallelFor without a cost hint, which is partitioned without calling it.
+struct UniformCost {
+  uint64_t operator()(size_t) const { return 1; }
+};
+
+class StealLoop {
+public:
+  StealLoop(size_t workers) : ranges(workers), claimed(workers) {}
+
+  // Claim a range for the calling runner to own, the preferred one if it is still free.  There are
+  // exactly as many runners as ranges, so every runner gets one of its own.
+  size_t claim(size_t preferred) {
+    if (preferred < claimed.size() && !claimed[preferred].exchange(true)) {
+      return preferred;
+    }
+    for (size_t i = 0;; i++) {
+      if (!claimed[i].exchange(true)) {
+        return i;
+      }
+    }
+  }
+
+  // Partition [begin, end) so that each worker starts with an equal share of the iterations, the
+  // same share that numa::fillRows places on the worker's node.
+  void partition(size_t begin, size_t end, UniformCost) {
+    remaining = end - begin;
+    size_t workers = ranges.size();
+    for (size_t w = 0; w < workers; w++) {
+      std::tie(ranges[w].begin, ranges[w].end) = numa::slotShare(w, workers, begin, end);
+    }
+  }
+
+  // Partition [begin, end) so that each worker starts with an equal share of the total cost.
+  // Worker w's range ends at the first iteration where the running cost reaches w + 1 shares.  The
+  // running cost is found in two passes over one block of iterations per worker: the first sums
+  // each block, and the second walks each block from the sum of those before it to find the
+  // boundaries that fall inside it.  Large ranges run both passes in parallel.
+  template <typename C> void partition(size_t begin, size_t end, C&& cost) {
+    remaining = end - begin;
+    size_t workers = ranges.size();
+    size_t count = end - begin;
+    auto blockBegin = [&](size_t block) { return begin + count * block / workers; };
+    auto forEachBlock = [&](auto&& body) {
+      if (count < kParallelPartition) {
+        for (size_t block = 0; block < workers; block++) {
+          body(block);
+        }
+      } else {
+        auto first = poolstl::iota_iter<size_t>(0);
+        auto last = poolstl::iota_iter<size_t>(workers);
+        std::for_each(poolstl::par, first, last, body);
+      }
+    };
+
+    // blockBase[b] is the cost of every iteration before block b.
+    std::vector<uint64_t> blockBase(workers + 1);
+    forEachBlock([&](size_t block) {
+      uint64_t sum = 0;
+      for (size_t i = blockBegin(block); i < blockBegin(block + 1); i++) {
+        sum += cost(i);
+      }
+      blockBase[block + 1] = sum;
+    });
+    for (size_t block = 0; block < workers; block++) {
+      blockBase[block + 1] += blockBase[block];
+    }
+    uint64_t total = blockBase[workers];
+    auto target = [&](size_t w) { return total * (w + 1) / workers; };
+
+    // bounds[w] is where worker w's range ends.  A target of zero is reached before any iteration.
+    std::vector<size_t> bounds(workers, begin);
+    bounds[workers - 1] = end;
+    forEachBlock([&](size_t block) {
+      // The targets in (blockBase[block], blockBase[block + 1]] are reached inside this block.
+      size_t w = 0;
+      while (w + 1 < workers && target(w) <= blockBase[block]) {
+        w++;
+      }
+      uint64_t sum = blockBase[block];
+      for (size_t i = blockBegin(block); i < blockBegin(block + 1) && w + 1 < workers; i++) {
+        sum += cost(i);
+        while (w + 1 < workers && target(w) <= sum) {
+          bounds[w++] = i + 1;
+        }
+      }
+    });
+
+    size_t cur = begin;
+    for (size_t w = 0; w < workers; w++) {
+      size_t next = std::max(cur, bounds[w]);
+      ranges[w].begin = cur;
+      ranges[w].end = next;
+      cur = next;
+    }
+  }
+
+  // The range that worker w was given by partition, before any of it is run.
+  std::pair<size_t, size_t> range(size_t w) const { return {ranges[w].begin, ranges[w].end}; }
+
+  // Run chunks of the loop until there are none left to take or steal.  Returns true if this call
+  // returned from the last iteration of the whole loop to do so, which then happens after every
+  // other iteration has returned.
+  template <typename F> bool run(size_t self, F& f) {
+    size_t first;
+    size_t last;
+    bool retiredLast = false;
+    while (!failed.load(std::memory_order_relaxed)) {
+      if (!take(self, first, last) && !steal(self, first, last)) {
+        break;
+      }
+      try {
+        for (size_t i = first; i < last; i++) {
+          f(i);
+        }
+        // Acquire-release, so that the effects of every other iteration are visible to the worker
+        // which retires the last one.
+        if (remaining.fetch_sub(last - first, std::memory_order_acq_rel) == last - first) {
+          retiredLast = true;
+        }
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(errorLock);
+        if (!error) {
+          error = std::current_exception();
+        }
+        failed = true;
+      }
+    }
+    return retiredLast;
+  }
+
+  void rethrow() {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+private:
+  std::vector<StealRange> ranges;
+  std::vector<std::atomic<bool>> claimed;
+  std::atomic<size_t> remaining{0};
+  std::atomic<bool> failed{false};
+  std::mutex errorLock;
+  std::exception_ptr error;
+
+  bool take(size_t self, size_t& first, size_t& last) {
+    StealRange& range = ranges[self];
+    std::lock_guard<std::mutex> lock(range.lock);
+    size_t remaining = range.end - range.begin;
+    if (remaining == 0) {
+      return false;
+    }
+    size_t grain = std::max<size_t>(1, remaining / kGrainDivisor);
+    first = range.begin;
+    last = first + grain;
+    range.begin = last;
+    return true;
+  }
+
+  // Take the back half of another worker's range.  The first chunk of it is returned to run right
+  // away, and the rest becomes this worker's range.
+  bool steal(size_t self, size_t& first, size_t& last) {
+    size_t workers = ranges.size();
+    for (size_t i = 1; i < workers; i++) {
+      StealRange& victim = ranges[(self + i) % workers];
+      size_t begin;
+      size_t end;
+      {
+        std::lock_guard<std::mutex> lock(victim.lock);
+        size_t remaining = victim.end - victim.begin;
+        if (remaining == 0) {
+          continue;
+        }
+        begin = victim.end - (remaining + 1) / 2;
+        end = victim.end;
+        victim.end = begin;
+      }
+      size_t grain = std::max<size_t>(1, (end - begin) / kGrainDivisor);
+      first = begin;
+      last = begin + grain;
+      StealRange& range = ranges[self];
+      std::lock_guard<std::mutex> lock(range.lock);
+      range.begin = last;
+      range.end = end;
+      return true;
+    }
+    return false;
+  }
+};
+
+template <typename F, typename C>
+inline void parallelForImpl(size_t begin, size_t end, F& f, C&& cost) {
+  if (begin >= end) {
+    return;
+  }
+  task_thread_pool::task_thread_pool* pool = poolstl::par.pool();
+  size_t workers = std::min<size_t>(std::max(1u, pool->get_num_threads()), end - begin);
+  StealLoop loop(workers);
+  // When the pool is pinned (see numa.h), the ranges follow the placement of numa::fillRows rather
+  // than the cost hint, and each range is run by the pool thread of the same slot where possible,
+  // which is the thread that had first touch the matching rows.  Stealing evens out the cost.  A
+  // caller from outside the pool is not pinned, so in that case it only waits.
+  bool pinned = numa::pinnedSlots() != 0;
+  if (pinned) {
+    loop.partition(begin, end, UniformCost());
+  } else {
+    loop.partition(begin, end, cost);
+  }
+  bool callerRuns = !pinned || numa::workerSlot() != SIZE_MAX;
+  size_t tasks = callerRuns ? workers - 1 : workers;
+  std::vector<std::future<void>> futures;
+  futures.reserve(tasks);
+  for (size_t i = 0; i < tasks; i++) {
+    futures.push_back(pool->submit([&loop, &f] { loop.run(loop.claim(numa::workerSlot()), f); }));
+  }
+  if (callerRuns) {
+    loop.run(loop.claim(numa::workerSlot()), f);
+  }
+  for (auto& future : futures) {
+    future.get();
+  }
+  loop.rethrow();
+}
+
+// See parallelForGated.
+template <typename F, typename C>
+inline void parallelForGatedImpl(
+    size_t begin, size_t gate, size_t gateEnd, size_t end, F& f, C&& cost) {
+  if (gate <= begin || gateEnd <= gate) {
+    // Nothing to wait for, or nothing waiting.
+    parallelForImpl(begin, end, f, cost);
+    return;
+  }
+  task_thread_pool::task_thread_pool* pool = poolstl::par.pool();
+  size_t threads = std::max(1u, pool->get_num_threads());
+  size_t workers = std::min<size_t>(threads, std::max(gate - begin, end - gateEnd));
+  size_t gatedWorkers = std::min<size_t>(threads, gateEnd - gate);
+  StealLoop before(workers);
+  StealLoop gated(gatedWorkers);
+  StealLoop fill(workers);
+  // See parallelForImpl for the partitioning of a pinned pool.
+  bool pinned = numa::pinnedSlots() != 0;
+  if (pinned) {
+    before.partition(begin, gate, UniformCost());
+    gated.partition(gate, gateEnd, UniformCost());
+    fill.partition(gateEnd, end, UniformCost());
+  } else {
+    before.partition(begin, gate, cost);
+    gated.partition(gate, gateEnd, cost);
+    fill.partition(gateEnd, end, cost);
+  }
+
+  // The gated loop is started by whichever worker retires the last iteration before the gate.  It
+  // submits the rest of the gated loop's workers to the pool as new tasks, which the workers that
+  // ran out of work before then are free to pick up, since they never wait for the gate.
+  std::mutex gatedLock;
+  std::vector<std::future<void>> gatedFutures;
+  auto runGated = [&gated, &f] { gated.run(gated.claim(numa::workerSlot()), f); };
+  auto runner = [&] {
+    size_t slot = numa::workerSlot();
+    if (before.run(before.claim(slot), f)) {
+      {
+        std::lock_guard<std::mutex> lock(gatedLock);
+        for (size_t i = 1; i < gatedWorkers; i++) {
+          gatedFutures.push_back(pool->submit(runGated));
+        }
+      }
+      runGated();
+    }
+    // The iterations after the gated ones depend on neither, so they fill in while the other
+    // workers finish the last iterations before the gate.
+    fill.run(fill.claim(slot), f);
+  };
+
+  bool callerRuns = !pinned || numa::workerSlot() != SIZE_MAX;
+  size_t tasks = callerRuns ? workers - 1 : workers;
+  std::vector<std::future<void>> futures;
+  futures.reserve(tasks);
+  for (size_t i = 0; i < tasks; i++) {
+    futures.push_back(pool->submit(runner));
+  }
+  if (callerRuns) {
+    runner();
+  }
+  for (auto& future : futures) {
+    future.get();
+  }
+  // Every runner has returned, so the gated loop's tasks have all been submitted, if it started.
+  for (auto& future : gatedFutures) {
+    future.get();
+  }
+  before.rethrow();
+  gated.rethrow();
+  fill.rethrow();
+}
+
+} // namespace detail
+
+/// Call f(i) for every i in [begin, end) on the thread pool.  Unlike a poolstl parallel for_each,
+/// which splits the range evenly up front, workers take adaptively sized chunks from their own
+/// share of the range and steal from the others when they run out, so iterations of very uneven
+/// cost still finish together.  If any call throws, the remaining work is abandoned and the first
+/// exception is rethrown.
+template <typename F> inline void parallelFor(size_t begin, size_t end, F f) {
+  detail::parallelForImpl(begin, end, f, detail::UniformCost());
+}
+
+/// A version of parallelFor with a cost hint: cost(i) is the relative cost of iteration i, which is
+/// used to give each worker an equal share of the total cost to start with.  The hint only needs to
+/// be roughly right, since stealing evens out the rest.
+template <typename F, typename C> inline void parallelFor(size_t begin, size_t end, F f, C cost) {
+  detail::parallelForImpl(begin, end, f, cost);
+}
+
+/// A version of parallelFor with a cost hint, where the iterations in [gate, gateEnd) depend on
+/// every iteration in [begin, gate), and those in [gateEnd, end) depend on neither.  Rather than a
+/// barrier at the gate, the worker which retires the last iteration before the gate starts the
+/// gated iterations on the pool, while the rest fill in with the iterations after gateEnd.  No
+/// worker ever waits for the gate.  If any call throws, the remaining work is abandoned and the
+/// first exception is rethrown, and if one before the gate throws, no gated iteration is run.
+template <typename F, typename C>
+inline void parallelForGated(size_t begin, size_t gate, size_t gateEnd, size_t end, F f, C cost) {
+  detail::parallelForGatedImpl(begin, gate, gateEnd, end, f, cost);
+}
+
+} // namespace risc0
@@ -0,0 +1,99 @@
+// Copyright 2025 RISC Zero, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/// \file
+/// Parallel inclusive prefix sums of Fp and FpExt arrays.
+
+#include "fp.h"
+#include "fpext.h"
+#include "parallel_for.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace risc0 {
+
+namespace detail {
+
+// A two-pass block scan over each of cols columns of count elements, stride elements apart.  The
+// first pass sums every block but the last of each column in parallel, a short serial scan over
+// the block sums gives the offset each block starts from, and the second pass scans every block
+// from its offset in parallel.  Each element is read twice and written once, against once each for
+// a serial scan, which is soon paid back by the extra threads.
+template <typename T>
+inline void prefixSumPar(T* data, size_t stride, size_t cols, size_t count, size_t blockSize) {
+  if (count == 0) {
+    return;
+  }
+  blockSize = std::max<size_t>(1, blockSize);
+  size_t blocks = (count + blockSize - 1) / blockSize;
+  std::vector<T> offsets(cols * blocks);
+  parallelFor(0, cols * (blocks - 1), [&](size_t task) {
+    size_t col = task / (blocks - 1);
+    size_t block = task % (blocks - 1);
+    const T* src = data + col * stride + block * blockSize;
+    T sum;
+    for (size_t i = 0; i < blockSize; i++) {
+      sum += src[i];
+    }
+    offsets[col * blocks + block + 1] = sum;
+  });
+  for (size_t col = 0; col < cols; col++) {
+    T* colOffsets = offsets.data() + col * blocks;
+    for (size_t block = 1; block < blocks; block++) {
+      colOffsets[block] += colOffsets[block - 1];
+    }
+  }
+  parallelFor(0, cols * blocks, [&](size_t task) {
+    size_t col = task / blocks;
+    size_t block = task % blocks;
+    T* dst = data + col * stride + block * blockSize;
+    size_t len = std::min(blockSize, count - block * blockSize);
+    T acc = offsets[task];
+    for (size_t i = 0; i < len; i++) {
+      acc += dst[i];
+      dst[i] = acc;
+    }
+  });
+}
+
+} // namespace detail
+
+/// The default number of elements each task of prefixSum scans.
+constexpr size_t kPrefixSumBlockSize = 1 << 16;
+
+/// Replace each element of elems with the sum of itself and all the elements before it, like
+/// std::inclusive_scan, in parallel on the thread pool.
+inline void prefixSum(Fp* elems, size_t count, size_t blockSize = kPrefixSumBlockSize) {
+  detail::prefixSumPar(elems, count, 1, count, blockSize);
+}
+
+/// Replace each element of elems with the sum of itself and all the elements before it, like
+/// std::inclusive_scan, in parallel on the thread pool.
+inline void prefixSum(FpExt* elems, size_t count, size_t blockSize = kPrefixSumBlockSize) {
+  detail::prefixSumPar(elems, count, 1, count, blockSize);
+}
+
+/// A version of prefixSum over the first count elements of each of cols columns, where column c
+/// starts at data + c * stride.  An FpExt stored as four Fp columns is scanned by scanning each of
+/// its columns, and doing them together here shares the passes between them.
+inline void prefixSumColumns(
+    Fp* data, size_t stride, size_t cols, size_t count, size_t blockSize = kPrefixSumBlockSize) {
+  detail::prefixSumPar(data, stride, cols, count, blockSize);
+}
+
+} // namespace risc0
@@ -0,0 +1,166 @@
+// Copyright 2025 RISC Zero, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/// \file
+/// Roots of unity of the BabyBear field, and tables of their powers.
+
+#include "fp.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace risc0 {
+
+/// The largest power of two dividing P - 1 (P - 1 = 15 * 2^27).
+constexpr size_t kMaxRouPo2 = 27;
+
+/// 'Forward' root of unity for each power of two: kRouFwd[n] is a primitive 2^n-th root of unity.
+/// These are the same values as RootsOfUnity::ROU_FWD on the Rust side, and each entry is the
+/// square of the next one.
+constexpr Fp kRouFwd[kMaxRouPo2 + 1] = {
+    1,          2013265920, 284861408,  1801542727, 567209306,  740045640,  918899846,
+    1881002012, 1453957774, 65325759,   1538055801, 515192888,  483885487,  157393079,
+    1695124103, 2005211659, 1540072241, 88064245,   1542985445, 1269900459, 1461624142,
+    825701067,  682402162,  1311873874, 1164520853, 352275361,  18769,      137,
+};
+
+/// 'Reverse' root of unity for each power of two: kRouRev[n] is the inverse of kRouFwd[n].
+constexpr Fp kRouRev[kMaxRouPo2 + 1] = {
+    1,          2013265920, 1728404513, 1592366214, 196396260,  1253260071, 72041623,
+    1091445674, 145223211,  1446820157, 1030796471, 2010749425, 1827366325, 1239938613,
+    246299276,  596347512,  1893145354, 246074437,  1525739923, 1194341128, 1463599021,
+    704606912,  95395244,   15672543,   647517488,  584175179,  137728885,  749463956,
+};
+
+namespace detail {
+
+constexpr bool checkRouTables() {
+  for (size_t n = 0; n <= kMaxRouPo2; n++) {
+    if (kRouFwd[n] * kRouRev[n] != Fp(1)) {
+      return false;
+    }
+    if (n > 0 && (kRouFwd[n] * kRouFwd[n] != kRouFwd[n - 1] ||
+                  kRouRev[n] * kRouRev[n] != kRouRev[n - 1])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static_assert(checkRouTables(), "Inconsistent roots of unity");
+
+// Since kRou[po2]^(2^i) == kRou[po2 - i], w^k is the product of kRou[po2 - i] over the set bits i
+// of k, which needs at most po2 multiplies and no squarings.
+constexpr Fp rouPow(const Fp* rou, size_t po2, uint64_t k) {
+  Fp ret(1);
+  k &= (uint64_t(1) << po2) - 1;
+  for (size_t i = 0; k != 0; i++, k >>= 1) {
+    if (k & 1) {
+      ret *= rou[po2 - i];
+    }
+  }
+  return ret;
+}
+
+template <size_t PO2> constexpr std::array<Fp, size_t(1) << PO2> rouPowers(const Fp* rou) {
+  std::array<Fp, size_t(1) << PO2> ret{};
+  Fp cur(1);
+  for (size_t i = 0; i < ret.size(); i++) {
+    ret[i] = cur;
+    cur *= rou[PO2];
+  }
+  return ret;
+}
+
+} // namespace detail
+
+/// Compute kRouFwd[po2]^k, the k-th power of the forward 2^po2-th root of unity.
+constexpr inline Fp rouFwdPow(size_t po2, uint64_t k) {
+  return detail::rouPow(kRouFwd, po2, k);
+}
+
+/// Compute kRouRev[po2]^k, the k-th power of the reverse 2^po2-th root of unity.
+constexpr inline Fp rouRevPow(size_t po2, uint64_t k) {
+  return detail::rouPow(kRouRev, po2, k);
+}
+
+/// All 2^PO2 powers of kRouFwd[PO2], in order.  The table is built at compile time when used in a
+/// constexpr context, so this is intended for small transforms such as NTT butterfly stages.
+template <size_t PO2> constexpr std::array<Fp, size_t(1) << PO2> rouFwdPowers() {
+  static_assert(PO2 <= 12, "Use RouPowTable for large tables");
+  return detail::rouPowers<PO2>(kRouFwd);
+}
+
+/// All 2^PO2 powers of kRouRev[PO2], in order, see rouFwdPowers.
+template <size_t PO2> constexpr std::array<Fp, size_t(1) << PO2> rouRevPowers() {
+  static_assert(PO2 <= 12, "Use RouPowTable for large tables");
+  return detail::rouPowers<PO2>(kRouRev);
+}
+
+/// A table of the powers w^k of a 2^po2-th root of unity w, for any po2 up to kMaxRouPo2.  A full
+/// table would need 2^po2 entries, so it is split into a low table of w^k for k < 2^lowBits and a
+/// high table of w^(k * 2^lowBits), which makes any lookup a single multiply while using only
+/// about 2 * 2^(po2 / 2) elements (32K entries at po2 = 27).
+class RouPowTable {
+  size_t po2;
+  size_t lowBits;
+  uint64_t lowMask;
+  std::vector<Fp> low;
+  std::vector<Fp> high;
+
+  static size_t checkPo2(size_t po2) {
+    if (po2 > kMaxRouPo2) {
+      throw std::runtime_error("RouPowTable po2 too large");
+    }
+    return po2;
+  }
+
+public:
+  RouPowTable(size_t po2, bool reverse = false)
+      : po2(checkPo2(po2))
+      , lowBits((po2 + 1) / 2)
+      , lowMask((uint64_t(1) << lowBits) - 1)
+      , low(size_t(1) << lowBits)
+      , high(size_t(1) << (po2 - lowBits)) {
+    const Fp* rou = reverse ? kRouRev : kRouFwd;
+    Fp cur(1);
+    for (size_t i = 0; i < low.size(); i++) {
+      low[i] = cur;
+      cur *= rou[po2];
+    }
+    // cur is now w^(2^lowBits), the step of the high table.
+    Fp step = cur;
+    cur = Fp(1);
+    for (size_t i = 0; i < high.size(); i++) {
+      high[i] = cur;
+      cur *= step;
+    }
+  }
+
+  /// The power of two of the root of unity.
+  size_t getPo2() const { return po2; }
+
+  /// Get w^k, k is taken modulo 2^po2.
+  Fp operator[](uint64_t k) const {
+    k &= (uint64_t(1) << po2) - 1;
+    return low[k & lowMask] * high[k >> lowBits];
+  }
+};
+
+} // namespace risc0
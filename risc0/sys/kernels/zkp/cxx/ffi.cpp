@@ -0,0 +1,69 @@
+// Copyright 2025 RISC Zero, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "fp.h"
+#include "fp_bulk.h"
+#include "hugepage.h"
+#include "numa.h"
+
+#include <cstddef>
+#include <cstdint>
+
+using namespace risc0;
+
+extern "C" {
+
+void risc0_fp_encode_bulk(uint32_t* out, const uint32_t* in, size_t count) {
+  encodeBulk(reinterpret_cast<Fp*>(out), in, count);
+}
+
+void risc0_fp_decode_bulk(uint32_t* out, const uint32_t* in, size_t count) {
+  decodeBulk(out, reinterpret_cast<const Fp*>(in), count);
+}
+
+void risc0_fp_encode_bulk_inplace(uint32_t* io, size_t count) {
+  encodeBulk(reinterpret_cast<Fp*>(io), io, count);
+}
+
+void risc0_fp_decode_bulk_inplace(uint32_t* io, size_t count) {
+  decodeBulk(io, reinterpret_cast<const Fp*>(io), count);
+}
+
+void risc0_fp_encode_bulk_strided(
+    uint32_t* out, size_t outStride, const uint32_t* in, size_t inStride, size_t count) {
+  encodeBulkStrided(reinterpret_cast<Fp*>(out), outStride, in, inStride, count);
+}
+
+void risc0_fp_decode_bulk_strided(
+    uint32_t* out, size_t outStride, const uint32_t* in, size_t inStride, size_t count) {
+  decodeBulkStrided(out, outStride, reinterpret_cast<const Fp*>(in), inStride, count);
+}
+
+void risc0_numa_pin_workers() {
+  numa::pinWorkers();
+}
+
+void risc0_numa_fill_rows(uint32_t* buf, size_t rows, size_t cols, uint32_t value) {
+  numa::fillRows(buf, rows, cols, value);
+}
+
+HugeAlloc risc0_huge_alloc(size_t bytes) {
+  return hugeAlloc(bytes);
+}
+
+void risc0_huge_free(const HugeAlloc* alloc) {
+  hugeFree(*alloc);
+}
+
+} // extern "C"
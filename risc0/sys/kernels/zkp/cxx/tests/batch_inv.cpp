@@ -0,0 +1,81 @@
+// Copyright 2025 RISC Zero, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Checks batchInv and batchInvParallel against inv, including zero entries, which must stay zero
+// without disturbing the inverses of the rest of the batch.
+
+#include "batch_inv.h"
+#include "test.h"
+
+using namespace risc0;
+using namespace risc0::test;
+
+namespace {
+
+Fp randomElem(Rng& rng, Fp) {
+  return rng.fp();
+}
+
+FpExt randomElem(Rng& rng, FpExt) {
+  return FpExt(rng.fp(), rng.fp(), rng.fp(), rng.fp());
+}
+
+// count elements, with zeros at both ends, in a run in the middle and scattered at random.
+template <typename T> std::vector<T> withZeros(Rng& rng, size_t count) {
+  std::vector<T> elems(count);
+  for (size_t i = 0; i < count; i++) {
+    bool zero = i == 0 || i + 1 == count || (i >= count / 2 && i < count / 2 + 3) ||
+                rng.next() % 8 == 0;
+    elems[i] = zero ? T() : randomElem(rng, T());
+  }
+  return elems;
+}
+
+template <typename T> void checkInverses(const std::vector<T>& in, const std::vector<T>& out) {
+  TEST_CHECK(in.size() == out.size());
+  for (size_t i = 0; i < in.size(); i++) {
+    TEST_CHECK(out[i] == inv(in[i]));
+    if (in[i] == T()) {
+      TEST_CHECK(out[i] == T());
+    }
+  }
+}
+
+template <typename T> void testBatchInv(uint64_t seed) {
+  Rng rng(seed);
+  for (size_t count : {0, 1, 2, 3, 100, 4097}) {
+    std::vector<T> in = withZeros<T>(rng, count);
+    std::vector<T> out = in;
+    batchInv(out.data(), out.size());
+    checkInverses(in, out);
+    for (size_t chunkSize : {0, 1, 7, 64, 4096}) {
+      out = in;
+      batchInvParallel(out.data(), out.size(), chunkSize);
+      checkInverses(in, out);
+    }
+  }
+
+  std::vector<T> zeros(10);
+  batchInv(zeros.data(), zeros.size());
+  checkInverses(std::vector<T>(10), zeros);
+}
+
+} // namespace
+
+extern "C" const char* risc0_sys_test_batch_inv() {
+  return run([] {
+    testBatchInv<Fp>(3);
+    testBatchInv<FpExt>(4);
+  });
+}
@@ -0,0 +1,98 @@
+// Copyright 2025 RISC Zero, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Checks the bulk conversions against the scalar Fp(uint32_t) and asUInt32(), over counts which do and don't
+// fill the last vector, in place, and strided.
+
+#include "fp_bulk.h"
+#include "test.h"
+
+using namespace risc0;
+using namespace risc0::test;
+
+namespace {
+
+// Plain values, including the edges of the field and values >= P, which encode wraps.
+std::vector<uint32_t> plainValues(Rng& rng, size_t count) {
+  std::vector<uint32_t> ret = {0, 1, Fp::P - 1, Fp::P, Fp::P + 1, 0xffffffff};
+  while (ret.size() < count) {
+    ret.push_back(uint32_t(rng.next()));
+  }
+  ret.resize(count);
+  return ret;
+}
+
+void testRoundTrip(Rng& rng, size_t count) {
+  std::vector<uint32_t> plain = plainValues(rng, count);
+  std::vector<Fp> encoded(count);
+  encodeBulk(encoded.data(), plain.data(), count);
+  for (size_t i = 0; i < count; i++) {
+    TEST_CHECK(encoded[i] == Fp(plain[i]));
+  }
+
+  std::vector<uint32_t> decoded(count);
+  decodeBulk(decoded.data(), encoded.data(), count);
+  for (size_t i = 0; i < count; i++) {
+    TEST_CHECK(decoded[i] == encoded[i].asUInt32());
+    TEST_CHECK(decoded[i] == plain[i] % Fp::P);
+  }
+
+  std::vector<uint32_t> io = plain;
+  encodeBulk(reinterpret_cast<Fp*>(io.data()), io.data(), count);
+  for (size_t i = 0; i < count; i++) {
+    TEST_CHECK(io[i] == encoded[i].asRaw());
+  }
+  decodeBulk(io.data(), reinterpret_cast<const Fp*>(io.data()), count);
+  TEST_CHECK(io == decoded);
+}
+
+void testStrided(Rng& rng, size_t count, size_t inStride, size_t outStride) {
+  const uint32_t guard = 0xdeadbeef;
+  std::vector<uint32_t> plain = plainValues(rng, count * inStride);
+  std::vector<Fp> encoded(count * outStride + 1, Fp::fromRaw(guard));
+  encodeBulkStrided(encoded.data(), outStride, plain.data(), inStride, count);
+  for (size_t i = 0; i < encoded.size(); i++) {
+    if (i % outStride == 0 && i / outStride < count) {
+      TEST_CHECK(encoded[i] == Fp(plain[i / outStride * inStride]));
+    } else {
+      TEST_CHECK(encoded[i].asRaw() == guard);
+    }
+  }
+
+  std::vector<uint32_t> decoded(count * inStride + 1, guard);
+  decodeBulkStrided(decoded.data(), inStride, encoded.data(), outStride, count);
+  for (size_t i = 0; i < decoded.size(); i++) {
+    if (i % inStride == 0 && i / inStride < count) {
+      TEST_CHECK(decoded[i] == plain[i] % Fp::P);
+    } else {
+      TEST_CHECK(decoded[i] == guard);
+    }
+  }
+}
+
+} // namespace
+
+extern "C" const char* risc0_sys_test_fp_bulk() {
+  return run([] {
+    Rng rng(6);
+    for (size_t count : {0, 1, 7, 8, 15, 16, 17, 33, 1000}) {
+      testRoundTrip(rng, count);
+      for (size_t inStride : {1, 3}) {
+        for (size_t outStride : {1, 2, 5}) {
+          testStrided(rng, count, inStride, outStride);
+        }
+      }
+    }
+  });
+}
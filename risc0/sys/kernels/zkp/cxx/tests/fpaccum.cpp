@@ -0,0 +1,92 @@
+// Copyright 2025 RISC Zero, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Checks FpAccum and FpExtAccum against sums of products reduced term by term.
+
+#include "fpaccum.h"
+#include "test.h"
+
+using namespace risc0;
+using namespace risc0::test;
+
+namespace {
+
+FpExt randomExt(Rng& rng) {
+  return FpExt(rng.fp(), rng.fp(), rng.fp(), rng.fp());
+}
+
+void testFpAccum() {
+  Rng rng(1);
+  std::vector<Fp> lhs, rhs;
+  edgePairs(rng, 4096, lhs, rhs);
+  FpAccum accum;
+  Fp expected;
+  for (size_t i = 0; i < lhs.size(); i++) {
+    accum.mulAdd(lhs[i], rhs[i]);
+    expected += lhs[i] * rhs[i];
+    TEST_CHECK(accum.reduce() == expected);
+  }
+  for (size_t i = 0; i < lhs.size(); i++) {
+    accum.add(lhs[i]);
+    expected += lhs[i];
+  }
+  TEST_CHECK(accum.reduce() == expected);
+
+  // The largest raw operands carry out of the low word every few terms, so a long run of them
+  // checks that the carries are all counted.
+  Fp max = Fp::fromRaw(Fp::P - 1);
+  FpAccum worst;
+  Fp worstExpected;
+  for (size_t i = 0; i < (size_t(1) << 20); i++) {
+    worst.mulAdd(max, max);
+    worstExpected += max * max;
+  }
+  TEST_CHECK(worst.reduce() == worstExpected);
+  TEST_CHECK(FpAccum().reduce() == Fp(0));
+}
+
+void testFpExtAccum() {
+  Rng rng(2);
+  FpExtAccum accum;
+  FpExt expected;
+  for (size_t i = 0; i < 1024; i++) {
+    FpExt a = randomExt(rng);
+    FpExt b = randomExt(rng);
+    Fp c = rng.fp();
+    accum.mulAdd(a, b);
+    accum.mulAdd(b, c);
+    accum.add(a);
+    expected += a * b + b * c + a;
+  }
+  TEST_CHECK(accum.reduce() == expected);
+
+  Fp max = Fp::fromRaw(Fp::P - 1);
+  FpExt maxExt(max, max, max, max);
+  FpExtAccum worst;
+  FpExt worstExpected;
+  for (size_t i = 0; i < (size_t(1) << 16); i++) {
+    worst.mulAdd(maxExt, maxExt);
+    worstExpected += maxExt * maxExt;
+  }
+  TEST_CHECK(worst.reduce() == worstExpected);
+}
+
+} // namespace
+
+extern "C" const char* risc0_sys_test_fpaccum() {
+  return run([] {
+    testFpAccum();
+    testFpExtAccum();
+  });
+}
@@ -0,0 +1,154 @@
+// Copyright 2025 RISC Zero, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Checks the FpExt multiply, square, fma and inverse, and the addition chain of powPMinus2, against
+// schoolbook references computed on plain integers mod P.
+
+#include "fpext.h"
+#include "test.h"
+
+#include <array>
+
+using namespace risc0;
+using namespace risc0::test;
+
+namespace {
+
+using Ref = std::array<uint64_t, 4>;
+
+constexpr uint64_t kP = Fp::P;
+constexpr uint64_t kBeta = 11;
+
+uint64_t mulMod(uint64_t a, uint64_t b) {
+  return a * b % kP;
+}
+
+uint64_t powMod(uint64_t x, uint64_t n) {
+  uint64_t tot = 1;
+  for (; n != 0; n /= 2) {
+    if (n % 2 == 1) {
+      tot = mulMod(tot, x);
+    }
+    x = mulMod(x, x);
+  }
+  return tot;
+}
+
+Ref toRef(FpExt x) {
+  return {
+      x.elems[0].asUInt32(), x.elems[1].asUInt32(), x.elems[2].asUInt32(), x.elems[3].asUInt32()};
+}
+
+// Multiply out the polynomials and reduce mod X^4 - beta, one coefficient at a time.
+Ref refMul(const Ref& a, const Ref& b) {
+  uint64_t prod[7] = {};
+  for (size_t i = 0; i < 4; i++) {
+    for (size_t j = 0; j < 4; j++) {
+      prod[i + j] = (prod[i + j] + mulMod(a[i], b[j])) % kP;
+    }
+  }
+  Ref ret;
+  for (size_t i = 0; i < 4; i++) {
+    uint64_t high = i + 4 < 7 ? prod[i + 4] : 0;
+    ret[i] = (prod[i] + kP - mulMod(kBeta, high)) % kP;
+  }
+  return ret;
+}
+
+// Operands with the same edge value in every coefficient (including P-1 and the raw edges), every
+// ordered pair of edge values in mixed positions, and random values.
+std::vector<FpExt> operands(Rng& rng, size_t count) {
+  std::vector<FpExt> ret;
+  std::vector<Fp> edges = edgeValues();
+  edges.push_back(Fp(Fp::P - 1));
+  for (Fp x : edges) {
+    ret.push_back(FpExt(x, x, x, x));
+  }
+  std::vector<Fp> lhs, rhs;
+  edgePairs(rng, count, lhs, rhs);
+  for (size_t i = 0; i < lhs.size(); i++) {
+    ret.push_back(FpExt(lhs[i], rhs[i], rhs[i], lhs[i]));
+    ret.push_back(FpExt(rng.fp(), lhs[i], rng.fp(), rhs[i]));
+  }
+  return ret;
+}
+
+void testMul() {
+  Rng rng(1);
+  std::vector<FpExt> xs = operands(rng, 256);
+  for (FpExt a : xs) {
+    for (size_t i = 0; i < xs.size(); i += 7) {
+      FpExt b = xs[i];
+      TEST_CHECK(toRef(a * b) == refMul(toRef(a), toRef(b)));
+    }
+    TEST_CHECK(a.square() == a * a);
+    TEST_CHECK(toRef(a.square()) == refMul(toRef(a), toRef(a)));
+  }
+}
+
+void testFma() {
+  Rng rng(2);
+  std::vector<FpExt> xs = operands(rng, 256);
+  std::vector<Fp> scalars = edgeValues();
+  scalars.push_back(Fp(Fp::P - 1));
+  for (size_t i = 0; i < 64; i++) {
+    scalars.push_back(rng.fp());
+  }
+  for (size_t i = 0; i < xs.size(); i++) {
+    FpExt acc = xs[xs.size() - 1 - i];
+    for (Fp b : scalars) {
+      TEST_CHECK(fma(acc, xs[i], b) == acc + xs[i] * FpExt(b));
+    }
+  }
+}
+
+void testInv() {
+  Rng rng(3);
+  TEST_CHECK(inv(FpExt()) == FpExt());
+  for (FpExt x : operands(rng, 256)) {
+    if (x == FpExt()) {
+      continue;
+    }
+    FpExt y = inv(x);
+    TEST_CHECK(x * y == FpExt(1));
+    TEST_CHECK((refMul(toRef(x), toRef(y)) == Ref{1, 0, 0, 0}));
+  }
+}
+
+void testPowPMinus2() {
+  Rng rng(4);
+  std::vector<Fp> xs = edgeValues();
+  xs.push_back(Fp(Fp::P - 1));
+  for (size_t i = 0; i < 256; i++) {
+    xs.push_back(rng.fp());
+  }
+  for (Fp x : xs) {
+    Fp y = powPMinus2(x);
+    TEST_CHECK(y.asUInt32() == powMod(x.asUInt32(), kP - 2));
+    TEST_CHECK(y == pow(x, Fp::P - 2));
+    TEST_CHECK(inv(x) == y);
+    TEST_CHECK(x == Fp(0) || x * y == Fp(1));
+  }
+}
+
+} // namespace
+
+extern "C" const char* risc0_sys_test_fpext() {
+  return run([] {
+    testMul();
+    testFma();
+    testInv();
+    testPowPMinus2();
+  });
+}
@@ -0,0 +1,143 @@
+// Copyright 2025 RISC Zero, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Checks every FpExtVec width against FpExt, lane by lane, see fpvec.cpp for the backends.
+
+#include "fpextvec.h"
+#include "test.h"
+
+#include <algorithm>
+
+using namespace risc0;
+using namespace risc0::test;
+
+namespace {
+
+// count extension elements whose coefficients run through every pair of edge values, with some
+// whole lanes of zero so that inv sees them.
+std::vector<FpExt> extValues(Rng& rng, size_t count) {
+  std::vector<Fp> lhs, rhs;
+  edgePairs(rng, count, lhs, rhs);
+  std::vector<FpExt> ret;
+  for (size_t i = 0; i < count; i++) {
+    ret.push_back(i % 13 == 5 ? FpExt() : FpExt(lhs[i], rhs[i], rng.fp(), lhs[(i * 7) % count]));
+  }
+  return ret;
+}
+
+template <size_t N> void testFpExtVec() {
+  Rng rng(N);
+  size_t count = 256 / N * N;
+  std::vector<FpExt> lhs = extValues(rng, count);
+  std::vector<FpExt> rhs = extValues(rng, count);
+  std::reverse(rhs.begin(), rhs.end());
+  std::vector<Fp> base(count);
+  for (Fp& x : base) {
+    x = rng.fp();
+  }
+
+  for (size_t i = 0; i < count; i += N) {
+    FpExtVec<N> a = FpExtVec<N>::loadPacked(&lhs[i]);
+    FpExtVec<N> b = FpExtVec<N>::loadPacked(&rhs[i]);
+    FpVec<N> c = FpVec<N>::load(&base[i]);
+    FpExtVec<N> acc = a;
+    acc += b;
+    acc *= b;
+    acc -= a;
+    acc *= c;
+    FpExtVec<N> sum = a + b;
+    FpExtVec<N> diff = a - b;
+    FpExtVec<N> prod = a * b;
+    FpExtVec<N> neg = -a;
+    FpExtVec<N> scaled = a * c;
+    FpExtVec<N> scaledLeft = c * a;
+    FpExtVec<N> plusBase = a + c;
+    FpExtVec<N> basePlus = c + a;
+    FpExtVec<N> minusBase = a - c;
+    FpExtVec<N> baseMinus = c - a;
+    FpExtVec<N> promoted = c;
+    FpExtVec<N> cube = pow(a, 3);
+    FpExtVec<N> recip = inv(a);
+    for (size_t j = 0; j < N; j++) {
+      FpExt x = lhs[i + j];
+      FpExt y = rhs[i + j];
+      Fp z = base[i + j];
+      TEST_CHECK(a[j] == x);
+      TEST_CHECK(sum[j] == x + y);
+      TEST_CHECK(diff[j] == x - y);
+      TEST_CHECK(prod[j] == x * y);
+      TEST_CHECK(neg[j] == -x);
+      TEST_CHECK(scaled[j] == x * z);
+      TEST_CHECK(scaledLeft[j] == x * z);
+      TEST_CHECK(plusBase[j] == x + FpExt(z));
+      TEST_CHECK(basePlus[j] == x + FpExt(z));
+      TEST_CHECK(minusBase[j] == x - FpExt(z));
+      TEST_CHECK(baseMinus[j] == FpExt(z) - x);
+      TEST_CHECK(promoted[j] == FpExt(z));
+      TEST_CHECK(acc[j] == ((x + y) * y - x) * z);
+      TEST_CHECK(cube[j] == x * x * x);
+      TEST_CHECK(recip[j] == inv(x));
+    }
+  }
+
+  // Column-major load and store, with the columns of a buffer of rows elements each.
+  size_t rows = count + 3;
+  std::vector<Fp> cols(4 * rows + 1, Fp::invalid());
+  for (size_t i = 0; i < count; i += N) {
+    FpExtVec<N>::loadPacked(&lhs[i]).store(&cols[1 + i], rows);
+  }
+  for (size_t i = 0; i < cols.size(); i++) {
+    size_t col = (i - 1) / rows;
+    size_t row = (i - 1) % rows;
+    if (i == 0 || row >= count) {
+      TEST_CHECK(cols[i] == Fp::invalid());
+    } else {
+      TEST_CHECK(cols[i] == lhs[row].elems[col]);
+    }
+  }
+  std::vector<FpExt> packed(count);
+  for (size_t i = 0; i < count; i += N) {
+    FpExtVec<N>::load(&cols[1 + i], rows).storePacked(&packed[i]);
+  }
+  for (size_t i = 0; i < count; i++) {
+    TEST_CHECK(packed[i] == lhs[i]);
+  }
+
+  // Broadcasts.
+  FpExt x = lhs[1];
+  FpExtVec<N> fromExt(x);
+  FpExtVec<N> fromCoeffs(x.elems[0], x.elems[1], x.elems[2], x.elems[3]);
+  FpExtVec<N> fromVecs(FpVec<N>(x.elems[0]),
+                       FpVec<N>(x.elems[1]),
+                       FpVec<N>(x.elems[2]),
+                       FpVec<N>(x.elems[3]));
+  FpExtVec<N> fromInt(7);
+  for (size_t j = 0; j < N; j++) {
+    TEST_CHECK(fromExt[j] == x);
+    TEST_CHECK(fromCoeffs[j] == x);
+    TEST_CHECK(fromVecs[j] == x);
+    TEST_CHECK(fromInt[j] == FpExt(7));
+    TEST_CHECK(FpExtVec<N>()[j] == FpExt());
+  }
+}
+
+} // namespace
+
+extern "C" const char* risc0_sys_test_fpextvec() {
+  return run([] {
+    testFpExtVec<4>();
+    testFpExtVec<8>();
+    testFpExtVec<16>();
+  });
+}
@@ -0,0 +1,104 @@
+// Copyright 2025 RISC Zero, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Checks FpLazy arithmetic against Fp, including operands at the very top of their bounds.
+
+#include "fplazy.h"
+#include "test.h"
+
+using namespace risc0;
+using namespace risc0::test;
+
+namespace {
+
+constexpr Fp kMax = Fp::fromRaw(Fp::P - 1);
+
+// The largest value FpLazy<K> can hold, K * P - 1, built as (P - 1) - 0 with the 0 widened to a
+// bound of K - 1, since subtraction adds a multiple of P that large.
+template <uint64_t K> constexpr FpLazy<K> largest() {
+  if constexpr (K == 1) {
+    return FpLazy<1>(kMax);
+  } else {
+    return FpLazy<1>(kMax) - FpLazy<K - 1>(Fp(0));
+  }
+}
+
+static_assert(largest<3>().canonical() == kMax);
+static_assert((largest<4>() * largest<5>()).canonical() == kMax * kMax);
+
+template <uint64_t K, uint64_t J> void checkLargest() {
+  FpLazy<K> a = largest<K>();
+  FpLazy<J> b = largest<J>();
+  TEST_CHECK(a.canonical() == kMax);
+  TEST_CHECK(a.asUInt32() == kMax.asUInt32());
+  TEST_CHECK(a * b == kMax * kMax);
+  TEST_CHECK(b * a == kMax * kMax);
+  TEST_CHECK(a * kMax == kMax * kMax);
+  TEST_CHECK(kMax * b == kMax * kMax);
+  TEST_CHECK(a == b);
+  if constexpr (K + J <= (uint64_t(1) << 32)) {
+    TEST_CHECK(a + b == kMax + kMax);
+    TEST_CHECK(a - b == Fp(0));
+  }
+  if constexpr (K < (uint64_t(1) << 32)) {
+    TEST_CHECK(-a == -kMax);
+    TEST_CHECK(a + kMax == kMax + kMax);
+    TEST_CHECK(kMax - a == Fp(0));
+  }
+}
+
+template <uint64_t K> void checkLargestWith() {
+  checkLargest<K, 1>();
+  checkLargest<K, 2>();
+  checkLargest<K, 3>();
+  checkLargest<K, 8>();
+  checkLargest<K, 1000>();
+  checkLargest<K, (uint64_t(1) << 32)>();
+}
+
+void testFpLazy() {
+  Rng rng(5);
+  std::vector<Fp> lhs, rhs;
+  edgePairs(rng, 4096, lhs, rhs);
+  for (size_t i = 0; i < lhs.size(); i++) {
+    Fp a = lhs[i];
+    Fp b = rhs[i];
+    Fp c = rng.fp();
+    FpLazy<1> la(a), lb(b), lc(c);
+    TEST_CHECK(la + lb == a + b);
+    TEST_CHECK(la - lb == a - b);
+    TEST_CHECK(-la == -a);
+    TEST_CHECK(la * lb == a * b);
+    TEST_CHECK(Fp((la + lb) * (lc - la)) == (a + b) * (c - a));
+    TEST_CHECK(((la + lb) + (lc + la)) * (lb - lc - la) == ((a + b) + (c + a)) * (b - c - a));
+    TEST_CHECK((la * lb + lc) * (la * lc - lb) == (a * b + c) * (a * c - b));
+    TEST_CHECK(-(-(-la)) * (la + lb + lc + la + lb + lc) == -a * (a + b + c + a + b + c));
+    TEST_CHECK((la + b) * (c - lb) - a == (a + b) * (c - b) - a);
+  }
+
+  checkLargestWith<1>();
+  checkLargestWith<2>();
+  checkLargestWith<3>();
+  checkLargestWith<4>();
+  checkLargestWith<5>();
+  checkLargestWith<7>();
+  checkLargestWith<(uint64_t(1) << 16) + 1>();
+  checkLargestWith<(uint64_t(1) << 32)>();
+}
+
+} // namespace
+
+extern "C" const char* risc0_sys_test_fplazy() {
+  return run([] { testFpLazy(); });
+}
@@ -0,0 +1,101 @@
+// Copyright 2025 RISC Zero, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Checks every FpVec width against Fp, lane by lane.  FpVec<8> and FpVec<16> are the AVX2 and
+// AVX-512 backends when the crate is built with those target features, and the scalar fallback
+// otherwise, while FpVec<4> is always the scalar fallback.
+
+#include "fpvec.h"
+#include "test.h"
+
+using namespace risc0;
+using namespace risc0::test;
+
+namespace {
+
+template <size_t N> void testFpVec() {
+  Rng rng(N);
+  std::vector<Fp> lhs, rhs;
+  edgePairs(rng, 1024, lhs, rhs);
+  size_t count = lhs.size() / N * N;
+  for (size_t i = 0; i < count; i += N) {
+    FpVec<N> a = FpVec<N>::load(&lhs[i]);
+    FpVec<N> b = FpVec<N>::load(&rhs[i]);
+    FpVec<N> sum = a + b;
+    FpVec<N> diff = a - b;
+    FpVec<N> prod = a * b;
+    FpVec<N> neg = -a;
+    FpVec<N> acc = a;
+    acc += b;
+    acc *= b;
+    acc -= a;
+    FpVec<N> cube = pow(a, 3);
+    FpVec<N> recip = inv(a);
+    for (size_t j = 0; j < N; j++) {
+      Fp x = lhs[i + j];
+      Fp y = rhs[i + j];
+      TEST_CHECK(a[j] == x);
+      TEST_CHECK(sum[j] == x + y);
+      TEST_CHECK(diff[j] == x - y);
+      TEST_CHECK(prod[j] == x * y);
+      TEST_CHECK(neg[j] == -x);
+      TEST_CHECK(acc[j] == (x + y) * y - x);
+      TEST_CHECK(cube[j] == x * x * x);
+      TEST_CHECK(recip[j] == inv(x));
+    }
+  }
+
+  // Results must come out fully reduced, since Fp compares raw values.
+  for (size_t i = 0; i < count; i += N) {
+    Fp out[N];
+    (FpVec<N>::load(&lhs[i]) * FpVec<N>::load(&rhs[i])).store(out);
+    for (size_t j = 0; j < N; j++) {
+      TEST_CHECK(out[j].asRaw() < Fp::P);
+    }
+  }
+
+  // Loads and stores are unaligned and touch exactly N elements.
+  std::vector<Fp> buf(3 * N + 2, Fp::invalid());
+  FpVec<N> src = FpVec<N>::load(&lhs[0]);
+  src.store(&buf[1]);
+  TEST_CHECK(buf[0] == Fp::invalid());
+  TEST_CHECK(buf[N + 1] == Fp::invalid());
+  for (size_t j = 0; j < N; j++) {
+    TEST_CHECK(buf[1 + j] == lhs[j]);
+  }
+  FpVec<N> reload = FpVec<N>::load(&buf[1]);
+  for (size_t j = 0; j < N; j++) {
+    TEST_CHECK(reload[j] == lhs[j]);
+  }
+
+  // Broadcast and default construction.
+  for (Fp x : edgeValues()) {
+    FpVec<N> splat(x);
+    for (size_t j = 0; j < N; j++) {
+      TEST_CHECK(splat[j] == x);
+      TEST_CHECK(FpVec<N>()[j] == Fp(0));
+    }
+  }
+}
+
+} // namespace
+
+extern "C" const char* risc0_sys_test_fpvec() {
+  return run([] {
+    testFpVec<4>();
+    testFpVec<8>();
+    testFpVec<16>();
+    testFpVec<FpVecNative::LANES>();
+  });
+}
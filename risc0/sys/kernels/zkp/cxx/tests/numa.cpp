@@ -0,0 +1,120 @@
+// Copyright 2025 RISC Zero, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Checks the NUMA placement helpers against fake topologies: which node each worker slot goes on,
+// that fills and parallelFor start each slot on the same share of the rows, and that a fill by
+// shares writes every element whichever threads run it.  Nothing here pins the real pool.
+
+#include "numa.h"
+#include "parallel_for.h"
+#include "test.h"
+
+using namespace risc0;
+using namespace risc0::test;
+
+namespace {
+
+void testEnabled() {
+  const char* env = getenv("RISC0_NUMA");
+  bool disabled = env && strcmp(env, "0") == 0;
+  TEST_CHECK(!numa::enabled(numa::Topology(std::vector<std::vector<int>>())));
+  TEST_CHECK(!numa::enabled(numa::Topology({{0, 1, 2, 3}})));
+  TEST_CHECK(numa::enabled(numa::Topology({{0, 1}, {2, 3}})) == !disabled);
+}
+
+// Every node gets a contiguous run of slots, the runs are in node order and differ in length by at
+// most one, and no node is left without a slot while there are at least as many slots as nodes.
+void testSlotNode() {
+  for (size_t nodes : {1, 2, 3, 4, 8}) {
+    std::vector<std::vector<int>> cpus(nodes);
+    for (size_t node = 0; node < nodes; node++) {
+      cpus[node] = {int(2 * node), int(2 * node + 1)};
+    }
+    numa::Topology topology(cpus);
+    for (size_t slots : {1, 2, 3, 5, 8, 16, 17, 64}) {
+      std::vector<size_t> perNode(nodes);
+      size_t prev = 0;
+      for (size_t slot = 0; slot < slots; slot++) {
+        size_t node = numa::slotNode(slot, slots, topology);
+        TEST_CHECK(node < nodes);
+        TEST_CHECK(node >= prev);
+        prev = node;
+        perNode[node]++;
+      }
+      size_t lo = *std::min_element(perNode.begin(), perNode.end());
+      size_t hi = *std::max_element(perNode.begin(), perNode.end());
+      TEST_CHECK(hi - lo <= 1);
+      if (slots >= nodes) {
+        TEST_CHECK(lo >= 1);
+      }
+    }
+  }
+}
+
+// The shares of the slots tile the range in order, and a uniform-cost parallelFor partition starts
+// each worker on exactly the share of the slot with the same index.
+void testSlotShare() {
+  for (size_t slots : {1, 2, 3, 7, 16}) {
+    for (auto [begin, end] : {std::pair<size_t, size_t>(0, 0),
+                              std::pair<size_t, size_t>(0, 5),
+                              std::pair<size_t, size_t>(3, 1000),
+                              std::pair<size_t, size_t>(0, size_t(1) << 20)}) {
+      detail::StealLoop loop(slots);
+      loop.partition(begin, end, detail::UniformCost());
+      size_t cur = begin;
+      for (size_t slot = 0; slot < slots; slot++) {
+        auto share = numa::slotShare(slot, slots, begin, end);
+        TEST_CHECK(share.first == cur);
+        TEST_CHECK(share.second >= share.first);
+        TEST_CHECK(share.second - share.first <= (end - begin) / slots + 1);
+        TEST_CHECK(loop.range(slot) == share);
+        cur = share.second;
+      }
+      TEST_CHECK(cur == end);
+    }
+  }
+}
+
+// The pool isn't pinned here, so every task takes the first free share, which covers a pool with
+// fewer threads than there are slots as well.
+void testFillShares() {
+  for (size_t slots : {1, 2, 3, 8}) {
+    for (auto [rows, cols] : {std::pair<size_t, size_t>(1, 1),
+                              std::pair<size_t, size_t>(5, 3),
+                              std::pair<size_t, size_t>(1024, 7)}) {
+      std::vector<uint32_t> buf(rows * cols, 0);
+      numa::detail::fillShares(buf.data(), rows, cols, 0x12345678u, slots);
+      for (uint32_t x : buf) {
+        TEST_CHECK(x == 0x12345678u);
+      }
+    }
+  }
+
+  std::vector<uint32_t> buf(4096 * 3, 0);
+  numa::fillRows(buf.data(), 4096, 3, 7u);
+  for (uint32_t x : buf) {
+    TEST_CHECK(x == 7u);
+  }
+}
+
+} // namespace
+
+extern "C" const char* risc0_sys_test_numa() {
+  return run([] {
+    testEnabled();
+    testSlotNode();
+    testSlotShare();
+    testFillShares();
+  });
+}
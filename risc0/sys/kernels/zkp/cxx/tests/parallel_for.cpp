@@ -0,0 +1,270 @@
+// Copyright 2025 RISC Zero, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Checks parallelFor: every iteration runs exactly once, including on empty and one-element ranges,
+// idle workers steal from a slow one, the first exception is rethrown, and the cost partition
+// matches a plain prefix sum search.  Also checks that exactly one worker retires the last
+// iteration of a StealLoop, and that parallelForGated only starts the gated iterations after every
+// one before the gate.
+
+#include "parallel_for.h"
+#include "test.h"
+
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <tuple>
+
+using namespace risc0;
+using namespace risc0::test;
+
+namespace {
+
+template <typename... C> void checkRunsOnce(size_t begin, size_t end, C... cost) {
+  std::vector<std::atomic<uint32_t>> runs(end + 1);
+  parallelFor(begin, end, [&](size_t i) { runs[i]++; }, cost...);
+  for (size_t i = 0; i < runs.size(); i++) {
+    TEST_CHECK(runs[i] == (i >= begin && i < end ? 1u : 0u));
+  }
+}
+
+void testRunsOnce() {
+  auto uneven = [](size_t i) { return uint64_t(i % 7 == 0 ? 100 : 1); };
+  for (auto [begin, end] : {std::pair<size_t, size_t>(0, 0),
+                            std::pair<size_t, size_t>(5, 5),
+                            std::pair<size_t, size_t>(7, 8),
+                            std::pair<size_t, size_t>(0, 1),
+                            std::pair<size_t, size_t>(3, 20),
+                            std::pair<size_t, size_t>(0, 100000)}) {
+    checkRunsOnce(begin, end);
+    checkRunsOnce(begin, end, uneven);
+  }
+}
+
+// Run a StealLoop on threads of its own, so that stealing is covered whatever the size of the
+// pool.  The first worker's share of the range is slow, so the others run out first and must steal
+// from it to finish.
+void testStealing() {
+  size_t workers = 4;
+  size_t count = 64 * workers;
+  size_t slow = count / workers;
+  detail::StealLoop loop(workers);
+  loop.partition(0, count, detail::UniformCost());
+  std::mutex lock;
+  std::set<std::thread::id> slowRunners;
+  std::vector<std::atomic<uint32_t>> runs(count);
+  auto f = [&](size_t i) {
+    runs[i]++;
+    if (i < slow) {
+      std::this_thread::sleep_for(std::chrono::microseconds(500));
+      std::lock_guard<std::mutex> guard(lock);
+      slowRunners.insert(std::this_thread::get_id());
+    }
+  };
+  std::vector<std::thread> threads;
+  for (size_t w = 0; w < workers; w++) {
+    threads.emplace_back([&, w] { loop.run(loop.claim(w), f); });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  loop.rethrow();
+  for (auto& run : runs) {
+    TEST_CHECK(run == 1);
+  }
+  TEST_CHECK(slowRunners.size() > 1);
+}
+
+// Exactly one worker sees its run retire the last iteration, and by then every iteration is done.
+void testRetiredLast() {
+  for (size_t count : {1, 5, 1000}) {
+    size_t workers = 4;
+    detail::StealLoop loop(workers);
+    loop.partition(0, count, detail::UniformCost());
+    std::atomic<size_t> done{0};
+    std::atomic<size_t> lastRunners{0};
+    std::atomic<size_t> doneAtLast{0};
+    auto f = [&](size_t) { done++; };
+    std::vector<std::thread> threads;
+    for (size_t w = 0; w < workers; w++) {
+      threads.emplace_back([&, w] {
+        if (loop.run(loop.claim(w), f)) {
+          lastRunners++;
+          doneAtLast = done.load();
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    TEST_CHECK(lastRunners == 1);
+    TEST_CHECK(doneAtLast == count);
+  }
+}
+
+void checkGated(size_t begin, size_t gate, size_t gateEnd, size_t end) {
+  std::vector<std::atomic<uint32_t>> runs(end + 1);
+  std::atomic<size_t> beforeDone{0};
+  std::atomic<size_t> early{0};
+  auto uneven = [](size_t i) { return uint64_t(i % 7 == 0 ? 100 : 1); };
+  parallelForGated(
+      begin,
+      gate,
+      gateEnd,
+      end,
+      [&](size_t i) {
+        if (i >= gate && i < gateEnd && beforeDone.load() != gate - begin) {
+          early++;
+        }
+        runs[i]++;
+        if (i < gate) {
+          beforeDone++;
+        }
+      },
+      uneven);
+  for (size_t i = 0; i < runs.size(); i++) {
+    TEST_CHECK(runs[i] == (i >= begin && i < end ? 1u : 0u));
+  }
+  TEST_CHECK(early == 0);
+}
+
+void testGated() {
+  for (auto [begin, gate, gateEnd, end] : {std::tuple<size_t, size_t, size_t, size_t>(0, 0, 0, 0),
+                                           {0, 0, 10, 20},
+                                           {0, 10, 10, 20},
+                                           {0, 10, 20, 20},
+                                           {3, 4, 5, 6},
+                                           {0, 100000, 104000, 110000},
+                                           {5, 1000, 2000, 100000}}) {
+    checkGated(begin, gate, gateEnd, end);
+  }
+
+  // A failure before the gate is rethrown, and nothing after the gate runs.
+  std::atomic<size_t> gatedRuns{0};
+  std::string what;
+  try {
+    parallelForGated(
+        0,
+        1000,
+        2000,
+        2000,
+        [&](size_t i) {
+          if (i == 500) {
+            throw std::runtime_error("bad iteration");
+          }
+          if (i >= 1000) {
+            gatedRuns++;
+          }
+        },
+        detail::UniformCost());
+  } catch (const std::runtime_error& err) {
+    what = err.what();
+  }
+  TEST_CHECK(what == "bad iteration");
+  TEST_CHECK(gatedRuns == 0);
+}
+
+void testException() {
+  for (size_t count : {1, 2, 1000, 100000}) {
+    size_t bad = count / 2;
+    std::atomic<size_t> failures{0};
+    std::string what;
+    try {
+      parallelFor(0, count, [&](size_t i) {
+        if (i == bad) {
+          failures++;
+          throw std::runtime_error("bad iteration");
+        }
+      });
+    } catch (const std::runtime_error& err) {
+      what = err.what();
+    }
+    TEST_CHECK(what == "bad iteration");
+    TEST_CHECK(failures == 1);
+  }
+}
+
+// The reference partition: worker w ends at the first prefix of the range whose cost reaches
+// w + 1 shares of the total.
+template <typename C>
+std::vector<size_t> referenceBounds(size_t begin, size_t end, size_t workers, C cost) {
+  std::vector<uint64_t> prefix(end - begin + 1);
+  for (size_t i = begin; i < end; i++) {
+    prefix[i - begin + 1] = prefix[i - begin] + cost(i);
+  }
+  uint64_t total = prefix.back();
+  std::vector<size_t> bounds;
+  for (size_t w = 0; w < workers; w++) {
+    uint64_t target = total * (w + 1) / workers;
+    size_t next = (w + 1 == workers)
+                      ? end
+                      : begin + (std::lower_bound(prefix.begin(), prefix.end(), target) -
+                                 prefix.begin());
+    bounds.push_back(next);
+  }
+  return bounds;
+}
+
+template <typename C> void checkPartition(size_t begin, size_t end, size_t workers, C cost) {
+  detail::StealLoop loop(workers);
+  loop.partition(begin, end, cost);
+  std::vector<size_t> bounds = referenceBounds(begin, end, workers, cost);
+  size_t cur = begin;
+  for (size_t w = 0; w < workers; w++) {
+    auto [first, last] = loop.range(w);
+    TEST_CHECK(first == cur);
+    TEST_CHECK(last == std::max(cur, bounds[w]));
+    cur = last;
+  }
+  TEST_CHECK(cur == end);
+}
+
+void testPartition() {
+  Rng rng(14);
+  std::vector<uint64_t> costs(300000);
+  for (auto& cost : costs) {
+    // Mostly cheap, some zero and a few very expensive, like the cycles of a trace.
+    uint64_t r = rng.next() % 64;
+    cost = r == 0 ? 0 : r == 1 ? 5000 : r % 4;
+  }
+  auto random = [&](size_t i) { return costs[i]; };
+  auto zero = [](size_t) { return uint64_t(0); };
+  auto front = [](size_t i) { return uint64_t(i < 10 ? 1000 : 0); };
+  for (size_t workers : {1, 2, 3, 7, 16}) {
+    for (auto [begin, end] : {std::pair<size_t, size_t>(0, 0),
+                              std::pair<size_t, size_t>(4, 5),
+                              std::pair<size_t, size_t>(10, 13),
+                              std::pair<size_t, size_t>(3, 1000),
+                              std::pair<size_t, size_t>(17, costs.size())}) {
+      checkPartition(begin, end, workers, random);
+      checkPartition(begin, end, workers, zero);
+      checkPartition(begin, end, workers, front);
+      checkPartition(begin, end, workers, detail::UniformCost());
+    }
+  }
+}
+
+} // namespace
+
+extern "C" const char* risc0_sys_test_parallel_for() {
+  return run([] {
+    testRunsOnce();
+    testStealing();
+    testRetiredLast();
+    testException();
+    testGated();
+    testPartition();
+  });
+}
@@ -0,0 +1,109 @@
+// Copyright 2025 RISC Zero, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Checks prefixSum and prefixSumColumns against std::inclusive_scan, for counts below, at and
+// around multiples of the block size, for both Fp and FpExt.
+
+#include "prefix_sum.h"
+#include "test.h"
+
+#include <numeric>
+
+using namespace risc0;
+using namespace risc0::test;
+
+namespace {
+
+Fp randomElem(Rng& rng, Fp) {
+  return rng.fp();
+}
+
+FpExt randomElem(Rng& rng, FpExt) {
+  return FpExt(rng.fp(), rng.fp(), rng.fp(), rng.fp());
+}
+
+template <typename T> std::vector<T> randomElems(Rng& rng, size_t count) {
+  std::vector<T> elems(count);
+  for (auto& elem : elems) {
+    elem = randomElem(rng, T());
+  }
+  return elems;
+}
+
+template <typename T> std::vector<T> expected(const std::vector<T>& elems) {
+  std::vector<T> ret(elems.size());
+  std::inclusive_scan(elems.begin(), elems.end(), ret.begin(), [](T a, T b) { return a + b; });
+  return ret;
+}
+
+template <typename T> void checkPrefixSum(Rng& rng, size_t count, size_t blockSize) {
+  std::vector<T> elems = randomElems<T>(rng, count);
+  std::vector<T> out = elems;
+  prefixSum(out.data(), out.size(), blockSize);
+  TEST_CHECK(out == expected(elems));
+}
+
+std::vector<size_t> counts(size_t blockSize) {
+  return {0,
+          1,
+          blockSize > 1 ? blockSize - 1 : 2,
+          blockSize,
+          blockSize + 1,
+          2 * blockSize,
+          3 * blockSize + 5};
+}
+
+template <typename T> void testPrefixSum(uint64_t seed) {
+  Rng rng(seed);
+  for (size_t blockSize : {0, 1, 2, 7, 64, 1000}) {
+    for (size_t count : counts(blockSize)) {
+      checkPrefixSum<T>(rng, count, blockSize);
+    }
+  }
+  // The default block size, with a single partial block and with several blocks.
+  for (size_t count : {size_t(100), kPrefixSumBlockSize - 1, 2 * kPrefixSumBlockSize + 3}) {
+    checkPrefixSum<T>(rng, count, kPrefixSumBlockSize);
+  }
+}
+
+// Each column is scanned on its own, and the padding between the end of one column and the start
+// of the next is left alone.
+void testColumns() {
+  Rng rng(21);
+  for (size_t blockSize : {1, 7, 64}) {
+    for (size_t count : counts(blockSize)) {
+      size_t cols = 4;
+      size_t stride = count + 3;
+      std::vector<Fp> data = randomElems<Fp>(rng, cols * stride);
+      std::vector<Fp> out = data;
+      prefixSumColumns(out.data(), stride, cols, count, blockSize);
+      for (size_t col = 0; col < cols; col++) {
+        auto first = data.begin() + col * stride;
+        std::vector<Fp> want = expected(std::vector<Fp>(first, first + count));
+        TEST_CHECK(std::equal(want.begin(), want.end(), out.begin() + col * stride));
+        TEST_CHECK(std::equal(first + count, first + stride, out.begin() + col * stride + count));
+      }
+    }
+  }
+}
+
+} // namespace
+
+extern "C" const char* risc0_sys_test_prefix_sum() {
+  return run([] {
+    testPrefixSum<Fp>(5);
+    testPrefixSum<FpExt>(6);
+    testColumns();
+  });
+}
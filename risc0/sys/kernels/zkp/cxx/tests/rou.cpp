@@ -0,0 +1,111 @@
+// Copyright 2025 RISC Zero, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Checks the roots of unity and every way of taking their powers against pow.
+
+#include "rou.h"
+#include "test.h"
+
+using namespace risc0;
+using namespace risc0::test;
+
+namespace {
+
+void testRoots() {
+  for (size_t n = 0; n <= kMaxRouPo2; n++) {
+    // kRouFwd[n] has order exactly 2^n.
+    TEST_CHECK(pow(kRouFwd[n], size_t(1) << n) == Fp(1));
+    if (n > 0) {
+      TEST_CHECK(pow(kRouFwd[n], size_t(1) << (n - 1)) == Fp(Fp::P - 1));
+    }
+    TEST_CHECK(kRouRev[n] == inv(kRouFwd[n]));
+  }
+}
+
+// Exponents near 0 and 2^po2, and random ones, which are taken modulo 2^po2.
+std::vector<uint64_t> exponents(Rng& rng, size_t po2) {
+  uint64_t order = uint64_t(1) << po2;
+  std::vector<uint64_t> ret = {0, 1, 2, order - 1, order, order + 1, 2 * order - 1, ~uint64_t(0)};
+  for (size_t i = 0; i < 32; i++) {
+    ret.push_back(rng.next());
+    ret.push_back(rng.next() % order);
+  }
+  return ret;
+}
+
+void testPow() {
+  Rng rng(8);
+  for (size_t po2 = 0; po2 <= kMaxRouPo2; po2++) {
+    uint64_t mask = (uint64_t(1) << po2) - 1;
+    for (uint64_t k : exponents(rng, po2)) {
+      TEST_CHECK(rouFwdPow(po2, k) == pow(kRouFwd[po2], k & mask));
+      TEST_CHECK(rouRevPow(po2, k) == pow(kRouRev[po2], k & mask));
+    }
+  }
+}
+
+template <size_t PO2> void checkPowers() {
+  constexpr auto fwd = rouFwdPowers<PO2>();
+  constexpr auto rev = rouRevPowers<PO2>();
+  for (size_t k = 0; k < fwd.size(); k++) {
+    TEST_CHECK(fwd[k] == pow(kRouFwd[PO2], k));
+    TEST_CHECK(rev[k] == pow(kRouRev[PO2], k));
+  }
+}
+
+void testPowers() {
+  checkPowers<0>();
+  checkPowers<1>();
+  checkPowers<4>();
+  checkPowers<12>();
+}
+
+void testPowTable() {
+  Rng rng(9);
+  for (size_t po2 : {0, 1, 2, 5, 10, 17, 27}) {
+    uint64_t mask = (uint64_t(1) << po2) - 1;
+    for (bool reverse : {false, true}) {
+      RouPowTable table(po2, reverse);
+      TEST_CHECK(table.getPo2() == po2);
+      Fp w = reverse ? kRouRev[po2] : kRouFwd[po2];
+      for (uint64_t k : exponents(rng, po2)) {
+        TEST_CHECK(table[k] == pow(w, k & mask));
+      }
+      if (po2 <= 10) {
+        for (uint64_t k = 0; k <= mask; k++) {
+          TEST_CHECK(table[k] == pow(w, k));
+        }
+      }
+    }
+  }
+
+  bool threw = false;
+  try {
+    RouPowTable table(kMaxRouPo2 + 1);
+  } catch (const std::runtime_error&) {
+    threw = true;
+  }
+  TEST_CHECK(threw);
+}
+
+} // namespace
+
+extern "C" const char* risc0_sys_test_rou() {
+  return run([] {
+    testRoots();
+    testPow();
+    testPowers();
+    testPowTable();
+  });
+}
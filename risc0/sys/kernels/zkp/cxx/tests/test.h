@@ -0,0 +1,100 @@
+// Copyright 2025 RISC Zero, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/// \file
+/// Helpers for the tests of the C++ primitives in cxx.  Each test is an extern "C" function which
+/// returns null on success or a message to be freed by the caller, and is run from a Rust #[test]
+/// in src/tests.rs, so the tests are built with whatever target features the crate is.
+
+#include "fp.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace risc0::test {
+
+#define TEST_CHECK(cond)                                                                           \
+  do {                                                                                             \
+    if (!(cond)) {                                                                                 \
+      throw std::runtime_error(std::string(__FILE__) + ":" + std::to_string(__LINE__) +           \
+                               ": check failed: " #cond);                                          \
+    }                                                                                              \
+  } while (0)
+
+/// Run a test body, catching any exception as the error message, like the FFI entry points do.
+template <typename F> inline const char* run(F f) {
+  try {
+    f();
+  } catch (const std::exception& err) {
+    return strdup(err.what());
+  } catch (...) {
+    return strdup("Generic exception");
+  }
+  return nullptr;
+}
+
+/// A small deterministic generator (splitmix64), so that failures reproduce.
+class Rng {
+public:
+  explicit Rng(uint64_t seed = 0) : state(seed) {}
+
+  uint64_t next() {
+    uint64_t z = (state += 0x9e3779b97f4a7c15);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+  }
+
+  Fp fp() { return Fp::fromRaw(next() % Fp::P); }
+
+private:
+  uint64_t state;
+};
+
+/// Field elements at and around the edges of the raw representation, where the reductions of an
+/// implementation are most likely to go wrong.
+inline std::vector<Fp> edgeValues() {
+  std::vector<uint32_t> raws = {0, 1, 2, (Fp::P - 1) / 2, (Fp::P + 1) / 2, Fp::P - 2, Fp::P - 1};
+  std::vector<Fp> ret;
+  for (uint32_t raw : raws) {
+    ret.push_back(Fp::fromRaw(raw));
+  }
+  return ret;
+}
+
+/// Fill lhs and rhs with at least count operands, starting with every ordered pair of edge values
+/// (lhs[i], rhs[i]), and padded out with random values.
+inline void edgePairs(Rng& rng, size_t count, std::vector<Fp>& lhs, std::vector<Fp>& rhs) {
+  std::vector<Fp> edges = edgeValues();
+  lhs.clear();
+  rhs.clear();
+  for (Fp a : edges) {
+    for (Fp b : edges) {
+      lhs.push_back(a);
+      rhs.push_back(b);
+    }
+  }
+  while (lhs.size() < count) {
+    lhs.push_back(rng.fp());
+    rhs.push_back(rng.fp());
+  }
+}
+
+} // namespace risc0::test
@@ -14,6 +14,8 @@
 
 #[cfg(feature = "cuda")]
 pub mod cuda;
+#[cfg(test)]
+mod tests;
 
 use std::ffi::CStr;
 
@@ -50,6 +52,67 @@ impl CppError {
     }
 }
 
+/// A mapping made by [risc0_huge_alloc], see `hugepage.h`.
+#[repr(C)]
+pub struct RawHugeAlloc {
+    pub ptr: *mut std::ffi::c_void,
+    pub len: usize,
+    /// The kind of pages backing the mapping: 0 for normal pages, 1 for transparent huge pages, 2
+    /// for explicit 2 MiB pages and 3 for explicit 1 GiB pages.
+    pub kind: u32,
+}
+
+extern "C" {
+    /// Convert `count` plain values to Montgomery form `Fp` values, wrapping values `>= P`.
+    pub fn risc0_fp_encode_bulk(out: *mut u32, input: *const u32, count: usize);
+
+    /// Convert `count` Montgomery form `Fp` values to plain values.
+    pub fn risc0_fp_decode_bulk(out: *mut u32, input: *const u32, count: usize);
+
+    /// In-place version of [risc0_fp_encode_bulk].
+    pub fn risc0_fp_encode_bulk_inplace(io: *mut u32, count: usize);
+
+    /// In-place version of [risc0_fp_decode_bulk].
+    pub fn risc0_fp_decode_bulk_inplace(io: *mut u32, count: usize);
+
+    /// Strided version of [risc0_fp_encode_bulk], strides are in elements.
+    pub fn risc0_fp_encode_bulk_strided(
+        out: *mut u32,
+        out_stride: usize,
+        input: *const u32,
+        input_stride: usize,
+        count: usize,
+    );
+
+    /// Strided version of [risc0_fp_decode_bulk], strides are in elements.
+    pub fn risc0_fp_decode_bulk_strided(
+        out: *mut u32,
+        out_stride: usize,
+        input: *const u32,
+        input_stride: usize,
+        count: usize,
+    );
+
+    /// Pin the threads of the C++ kernel thread pool to NUMA nodes, on a host with more than one
+    /// node. This is opt-in and lasts for the rest of the process, so call it once at startup,
+    /// before any kernel runs, and never from a kernel thread. Only the first call has any effect.
+    pub fn risc0_numa_pin_workers();
+
+    /// Fill a column-major buffer of `rows` x `cols` 32-bit elements with `value`. Once
+    /// [risc0_numa_pin_workers] has pinned the pool, each share of the rows is first touched by the
+    /// worker thread that later starts on those rows, so its pages are placed on that worker's
+    /// node.
+    pub fn risc0_numa_fill_rows(buf: *mut u32, rows: usize, cols: usize, value: u32);
+
+    /// Map `bytes` of zeroed memory on the largest pages available, falling back from explicit 1
+    /// GiB and 2 MiB huge pages to transparent huge pages to normal pages. On failure `ptr` is
+    /// null.
+    pub fn risc0_huge_alloc(bytes: usize) -> RawHugeAlloc;
+
+    /// Release a mapping made by [risc0_huge_alloc].
+    pub fn risc0_huge_free(alloc: *const RawHugeAlloc);
+}
+
 pub fn ffi_wrap<F>(mut inner: F) -> Result<()>
 where
     F: FnMut() -> *const std::os::raw::c_char,
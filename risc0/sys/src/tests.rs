@@ -0,0 +1,91 @@
+// Copyright 2025 RISC Zero, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! Runs the tests of the C++ primitives in `cxx`, see `kernels/zkp/cxx/tests`. They are built with
+//! the target features of the crate, so run them with and without `-C target-feature=+avx2` and
+//! `+avx512f` to cover each FpVec backend.
+
+use std::os::raw::c_char;
+
+use crate::ffi_wrap;
+
+#[link(name = "risc0_zkp_cpu_tests", kind = "static")]
+extern "C" {
+    fn risc0_sys_test_fpvec() -> *const c_char;
+    fn risc0_sys_test_fpaccum() -> *const c_char;
+    fn risc0_sys_test_batch_inv() -> *const c_char;
+    fn risc0_sys_test_fplazy() -> *const c_char;
+    fn risc0_sys_test_fp_bulk() -> *const c_char;
+    fn risc0_sys_test_fpext() -> *const c_char;
+    fn risc0_sys_test_fpextvec() -> *const c_char;
+    fn risc0_sys_test_rou() -> *const c_char;
+    fn risc0_sys_test_parallel_for() -> *const c_char;
+    fn risc0_sys_test_numa() -> *const c_char;
+    fn risc0_sys_test_prefix_sum() -> *const c_char;
+}
+
+#[test]
+fn fpvec() {
+    ffi_wrap(|| unsafe { risc0_sys_test_fpvec() }).unwrap();
+}
+
+#[test]
+fn fpaccum() {
+    ffi_wrap(|| unsafe { risc0_sys_test_fpaccum() }).unwrap();
+}
+
+#[test]
+fn batch_inv() {
+    ffi_wrap(|| unsafe { risc0_sys_test_batch_inv() }).unwrap();
+}
+
+#[test]
+fn fplazy() {
+    ffi_wrap(|| unsafe { risc0_sys_test_fplazy() }).unwrap();
+}
+
+#[test]
+fn fp_bulk() {
+    ffi_wrap(|| unsafe { risc0_sys_test_fp_bulk() }).unwrap();
+}
+
+#[test]
+fn fpext() {
+    ffi_wrap(|| unsafe { risc0_sys_test_fpext() }).unwrap();
+}
+
+#[test]
+fn fpextvec() {
+    ffi_wrap(|| unsafe { risc0_sys_test_fpextvec() }).unwrap();
+}
+
+#[test]
+fn rou() {
+    ffi_wrap(|| unsafe { risc0_sys_test_rou() }).unwrap();
+}
+
+#[test]
+fn parallel_for() {
+    ffi_wrap(|| unsafe { risc0_sys_test_parallel_for() }).unwrap();
+}
+
+#[test]
+fn numa() {
+    ffi_wrap(|| unsafe { risc0_sys_test_numa() }).unwrap();
+}
+
+#[test]
+fn prefix_sum() {
+    ffi_wrap(|| unsafe { risc0_sys_test_prefix_sum() }).unwrap();
+}
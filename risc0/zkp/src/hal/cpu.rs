@@ -14,14 +14,24 @@
 
 //! CPU implementation of the HAL.
 
-use std::{fmt::Debug, ops::Range, sync::Arc};
+use std::{
+    fmt::Debug,
+    mem::MaybeUninit,
+    ops::{Deref, DerefMut, Range},
+    ptr::NonNull,
+    sync::Arc,
+};
 
+use bytemuck::NoUninit;
 use ndarray::{ArrayView, ArrayViewMut, Axis};
 use parking_lot::{
     MappedRwLockReadGuard, MappedRwLockWriteGuard, RwLock, RwLockReadGuard, RwLockWriteGuard,
 };
 use rayon::prelude::*;
 use risc0_core::field::{Elem, ExtElem, Field};
+use risc0_sys::{
+    risc0_huge_alloc, risc0_huge_free, risc0_numa_fill_rows, risc0_numa_pin_workers, RawHugeAlloc,
+};
 
 use super::{tracker, Buffer, Hal};
 use crate::{
@@ -34,6 +44,17 @@ use crate::{
     FRI_FOLD,
 };
 
+/// Pin the threads of the C++ kernel thread pool to NUMA nodes, on a host with more than one node.
+/// After this, [CpuHal] places each share of the rows of a buffer from [Hal::alloc_elem_rows] on
+/// the node whose threads later start on those rows.
+///
+/// This is opt-in and lasts for the rest of the process. Call it once at startup, before any
+/// proving, from a thread that is not running a kernel. Set `RISC0_NUMA=0` to turn it into a
+/// no-op.
+pub fn pin_numa_workers() {
+    unsafe { risc0_numa_pin_workers() }
+}
+
 pub struct CpuHal<F: Field> {
     suite: HashSuite<F>,
 }
@@ -64,24 +85,128 @@ impl Region {
     }
 }
 
-struct TrackedVec<T>(Vec<T>);
+/// Buffers of at least this many bytes are mapped on huge pages where the host allows it.
+const HUGE_PAGE_MIN_BYTES: usize = 1 << 26;
+
+/// The kind of pages backing a [CpuBuffer].
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum PageKind {
+    /// Ordinary pages.
+    Normal,
+    /// Ordinary pages with transparent huge pages requested, which the kernel may or may not
+    /// provide.
+    Transparent,
+    /// Explicit 2 MiB huge pages.
+    Huge2M,
+    /// Explicit 1 GiB huge pages.
+    Huge1G,
+}
+
+/// The memory behind a [CpuBuffer]: either a [Vec], or for large buffers a mapping made by
+/// risc0-sys on the largest pages available.
+enum Storage<T> {
+    Vec(Vec<T>),
+    Mapped {
+        ptr: NonNull<T>,
+        len: usize,
+        raw: RawHugeAlloc,
+    },
+}
+
+// SAFETY: a mapping is owned exclusively by its Storage, just like the allocation of a Vec.
+unsafe impl<T: Send> Send for Storage<T> {}
+unsafe impl<T: Sync> Sync for Storage<T> {}
+
+impl<T> Storage<T> {
+    /// Map `len` elements if the buffer is large enough to be worth huge pages. `init` must write
+    /// every element through the pointer it is given.
+    unsafe fn map(len: usize, init: impl FnOnce(*mut T)) -> Option<Self> {
+        let bytes = len * std::mem::size_of::<T>();
+        if bytes < HUGE_PAGE_MIN_BYTES {
+            return None;
+        }
+        let raw = risc0_huge_alloc(bytes);
+        let ptr = NonNull::new(raw.ptr as *mut T)?;
+        init(ptr.as_ptr());
+        let storage = Self::Mapped { ptr, len, raw };
+        tracing::debug!("mapped {bytes} bytes on {:?} pages", storage.page_kind());
+        Some(storage)
+    }
+
+    fn bytes(&self) -> usize {
+        match self {
+            Self::Vec(vec) => vec.capacity() * std::mem::size_of::<T>(),
+            Self::Mapped { raw, .. } => raw.len,
+        }
+    }
+
+    fn page_kind(&self) -> PageKind {
+        match self {
+            Self::Vec(_) => PageKind::Normal,
+            Self::Mapped { raw, .. } => match raw.kind {
+                1 => PageKind::Transparent,
+                2 => PageKind::Huge2M,
+                3 => PageKind::Huge1G,
+                _ => PageKind::Normal,
+            },
+        }
+    }
+}
+
+impl<T> From<Vec<T>> for Storage<T> {
+    fn from(vec: Vec<T>) -> Self {
+        Self::Vec(vec)
+    }
+}
+
+impl<T> Deref for Storage<T> {
+    type Target = [T];
+
+    fn deref(&self) -> &[T] {
+        match self {
+            Self::Vec(vec) => vec,
+            Self::Mapped { ptr, len, .. } => unsafe {
+                std::slice::from_raw_parts(ptr.as_ptr(), *len)
+            },
+        }
+    }
+}
+
+impl<T> DerefMut for Storage<T> {
+    fn deref_mut(&mut self) -> &mut [T] {
+        match self {
+            Self::Vec(vec) => vec,
+            Self::Mapped { ptr, len, .. } => unsafe {
+                std::slice::from_raw_parts_mut(ptr.as_ptr(), *len)
+            },
+        }
+    }
+}
+
+impl<T> Drop for Storage<T> {
+    fn drop(&mut self) {
+        if let Self::Mapped { ptr, len, raw } = self {
+            unsafe {
+                std::ptr::drop_in_place(std::ptr::slice_from_raw_parts_mut(ptr.as_ptr(), *len));
+                risc0_huge_free(raw);
+            }
+        }
+    }
+}
+
+struct TrackedVec<T>(Storage<T>);
 
 impl<T> TrackedVec<T> {
-    pub fn new(vec: Vec<T>) -> Self {
-        tracker()
-            .lock()
-            .unwrap()
-            .alloc(vec.capacity() * std::mem::size_of::<T>());
-        Self(vec)
+    pub fn new(storage: impl Into<Storage<T>>) -> Self {
+        let storage = storage.into();
+        tracker().lock().unwrap().alloc(storage.bytes());
+        Self(storage)
     }
 }
 
 impl<T> Drop for TrackedVec<T> {
     fn drop(&mut self) {
-        tracker()
-            .lock()
-            .unwrap()
-            .free(self.0.capacity() * std::mem::size_of::<T>());
+        tracker().lock().unwrap().free(self.0.bytes());
     }
 }
 
@@ -161,20 +286,47 @@ impl<'a, T: Default + Clone> SyncSlice<'a, T> {
     }
 }
 
-impl<T: Default + Clone> CpuBuffer<T> {
+impl<T: Default + Clone + NoUninit + Send + Sync> CpuBuffer<T> {
     fn new(name: &'static str, size: usize) -> Self {
-        let buf = vec![T::default(); size];
-        CpuBuffer {
-            name,
-            buf: Arc::new(RwLock::new(TrackedVec::new(buf))),
-            region: Region(0, size),
+        let value = T::default();
+        // A mapping starts out zeroed, so a default of all zero bits needs no writes at all, and
+        // the pages stay untouched until the threads that use them first write them.
+        let zeroed = bytemuck::bytes_of(&value).iter().all(|&x| x == 0);
+        let storage = unsafe {
+            Storage::map(size, |ptr| {
+                if !zeroed {
+                    std::slice::from_raw_parts_mut(ptr as *mut MaybeUninit<T>, size)
+                        .par_iter_mut()
+                        .for_each(|x| {
+                            x.write(value.clone());
+                        });
+                }
+            })
         }
+        .unwrap_or_else(|| vec![value.clone(); size].into());
+        Self::from_storage(name, storage)
+    }
+}
+
+impl<T: Default + Clone> CpuBuffer<T> {
+    /// The kind of pages backing this buffer.
+    pub fn page_kind(&self) -> PageKind {
+        self.buf.read().0.page_kind()
     }
 
     pub fn get_ptr(&self) -> *mut T {
         self.as_slice_sync().get_ptr()
     }
 
+    fn from_storage(name: &'static str, storage: Storage<T>) -> Self {
+        let size = storage.len();
+        CpuBuffer {
+            name,
+            buf: Arc::new(RwLock::new(TrackedVec::new(storage))),
+            region: Region(0, size),
+        }
+    }
+
     fn copy_from(name: &'static str, slice: &[T]) -> Self {
         CpuBuffer {
             name,
@@ -256,7 +408,7 @@ impl<T: Clone> Buffer<T> for CpuBuffer<T> {
     }
 
     fn to_vec(&self) -> Vec<T> {
-        self.buf.read().0.clone()
+        self.buf.read().0.to_vec()
     }
 }
 
@@ -274,6 +426,36 @@ impl<F: Field> Hal for CpuHal<F> {
         CpuBuffer::copy_from(name, slice)
     }
 
+    fn alloc_elem_rows(
+        &self,
+        name: &'static str,
+        rows: usize,
+        cols: usize,
+        value: Self::Elem,
+    ) -> Self::Buffer<Self::Elem> {
+        if std::mem::size_of::<Self::Elem>() != std::mem::size_of::<u32>() {
+            return self.alloc_elem_init(name, rows * cols, value);
+        }
+        // The pages of a fresh allocation this large are not touched until they are first written,
+        // which risc0_numa_fill_rows does from the threads that will later process each row, if
+        // the pool has been pinned by pin_numa_workers.
+        let size = rows * cols;
+        // SAFETY: an elem the size of a u32 is a transparent wrapper around it, and every element
+        // is initialized by the fill before it is used.
+        let storage = unsafe {
+            let bits: u32 = std::mem::transmute_copy(&value);
+            let fill =
+                |ptr: *mut Self::Elem| risc0_numa_fill_rows(ptr as *mut u32, rows, cols, bits);
+            Storage::map(size, fill).unwrap_or_else(|| {
+                let mut vec = Vec::<Self::Elem>::with_capacity(size);
+                fill(vec.as_mut_ptr());
+                vec.set_len(size);
+                vec.into()
+            })
+        };
+        CpuBuffer::from_storage(name, storage)
+    }
+
     fn alloc_extelem(&self, name: &'static str, size: usize) -> Self::Buffer<Self::ExtElem> {
         CpuBuffer::new(name, size)
     }
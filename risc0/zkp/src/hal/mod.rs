@@ -82,6 +82,19 @@ pub trait Hal {
         buffer
     }
 
+    /// Allocate a column-major buffer of `rows` x `cols` elements initialized to `value`. Unlike
+    /// [Hal::alloc_elem_init], this knows the row layout, which lets a HAL place each range of
+    /// rows near the threads that process it.
+    fn alloc_elem_rows(
+        &self,
+        name: &'static str,
+        rows: usize,
+        cols: usize,
+        value: Self::Elem,
+    ) -> Self::Buffer<Self::Elem> {
+        self.alloc_elem_init(name, rows * cols, value)
+    }
+
     fn alloc_extelem_zeroed(&self, name: &'static str, size: usize) -> Self::Buffer<Self::ExtElem> {
         let buffer = self.alloc_extelem(name, size);
         buffer.view_mut(|slice| {